@@ -0,0 +1,164 @@
+/*
+ * Copyright 2026, agent
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * File:   v8_bench.cpp
+ * Author: agent
+ */
+
+#include "v8_bench.hpp"
+
+#include <algorithm>
+#include <cstdio>
+#include <numeric>
+
+#ifdef __linux__
+#include <unistd.h>
+#endif // __linux__
+
+#include "v8_bench_core_stub.hpp"
+
+namespace wilton {
+namespace v8bench {
+
+namespace { // anonymous
+
+double percentile(const std::vector<double>& sorted, double fraction) {
+    if (sorted.empty()) {
+        return 0;
+    }
+    auto idx = static_cast<size_t>(fraction * static_cast<double>(sorted.size() - 1) + 0.5);
+    return sorted.at(std::min(idx, sorted.size() - 1));
+}
+
+} // namespace
+
+void bench_samples::add(double us) {
+    values.push_back(us);
+}
+
+void bench_samples::add_since(std::chrono::steady_clock::time_point start) {
+    auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now() - start);
+    add(static_cast<double>(elapsed.count()) / 1000);
+}
+
+void bench_samples::add_all(const bench_samples& other) {
+    values.insert(values.end(), other.values.begin(), other.values.end());
+}
+
+double bench_samples::mean() const {
+    if (values.empty()) {
+        return 0;
+    }
+    return std::accumulate(values.begin(), values.end(), 0.0) / static_cast<double>(values.size());
+}
+
+sl::json::value bench_samples::to_json() const {
+    auto sorted = values;
+    std::sort(sorted.begin(), sorted.end());
+    return {
+        { "count", static_cast<int64_t>(sorted.size()) },
+        { "mean_us", mean() },
+        { "min_us", sorted.empty() ? 0.0 : sorted.front() },
+        { "p50_us", percentile(sorted, 0.5) },
+        { "p90_us", percentile(sorted, 0.9) },
+        { "p99_us", percentile(sorted, 0.99) },
+        { "max_us", sorted.empty() ? 0.0 : sorted.back() }
+    };
+}
+
+bench_env_scope::bench_env_scope(const std::string& name, const std::string& value) :
+name(name) {
+    stub_set_env(name, value);
+}
+
+bench_env_scope::~bench_env_scope() {
+    stub_unset_env(name);
+}
+
+bench_registrar::bench_registrar(const std::string& name, bench_fun fun) {
+    bench_cases().emplace_back(name, std::move(fun));
+}
+
+std::vector<std::pair<std::string, bench_fun>>& bench_cases() {
+    static std::vector<std::pair<std::string, bench_fun>> cases;
+    return cases;
+}
+
+const std::string& bench_init_code() {
+    static std::string code = std::string() +
+            "var BENCH_modules = {};\n"
+            "function WILTON_run(callbackScript) {\n"
+            "    var parsed = \"string\" !== typeof (callbackScript);\n"
+            "    var cs = parsed ? callbackScript : JSON.parse(callbackScript);\n"
+            "    if (!BENCH_modules.hasOwnProperty(cs.module)) {\n"
+            "        WILTON_load(\"" + stub_base_url + "\" + cs.module + \".js\");\n"
+            "    }\n"
+            "    var res = BENCH_modules[cs.module][cs.func].apply(null, cs.args);\n"
+            "    if (null === res || undefined === res) {\n"
+            "        return null;\n"
+            "    }\n"
+            "    if (parsed || \"string\" === typeof (res) || \"function\" === typeof (res.then)) {\n"
+            "        return res;\n"
+            "    }\n"
+            "    return JSON.stringify(res);\n"
+            "}\n";
+    return code;
+}
+
+void bench_add_module(const std::string& name, std::string code) {
+    stub_add_resource(stub_base_url + name + ".js", std::move(code));
+}
+
+std::string bench_callback(const std::string& module, const std::string& func,
+        const std::string& args) {
+    return std::string() + "{\"module\": " + sl::json::value(module).dumps() +
+            ", \"func\": " + sl::json::value(func).dumps() +
+            ", \"args\": " + args + "}";
+}
+
+std::unique_ptr<v8eng::v8_engine> bench_create_engine() {
+    auto& code = bench_init_code();
+    auto span = sl::io::span<const char>(code.data(), code.length());
+    return std::unique_ptr<v8eng::v8_engine>(new v8eng::v8_engine(span));
+}
+
+void bench_run(v8eng::v8_engine& engine, const std::string& callback) {
+    engine.run_callback_script({callback.data(), callback.length()});
+}
+
+uint64_t bench_rss_bytes() {
+#ifdef __linux__
+    auto file = std::fopen("/proc/self/statm", "r");
+    if (nullptr == file) {
+        return 0;
+    }
+    unsigned long long size = 0;
+    unsigned long long resident = 0;
+    auto read = std::fscanf(file, "%llu %llu", std::addressof(size), std::addressof(resident));
+    std::fclose(file);
+    if (2 != read) {
+        return 0;
+    }
+    return static_cast<uint64_t>(resident) * static_cast<uint64_t>(sysconf(_SC_PAGESIZE));
+#else // !__linux__
+    return 0;
+#endif // __linux__
+}
+
+} // namespace
+}
@@ -0,0 +1,142 @@
+/*
+ * Copyright 2026, agent
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * File:   v8_bench.hpp
+ * Author: agent
+ */
+
+#ifndef WILTON_V8_BENCH_HPP
+#define WILTON_V8_BENCH_HPP
+
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "staticlib/json.hpp"
+
+#include "v8_engine.hpp"
+
+namespace wilton {
+namespace v8bench {
+
+class bench_options {
+public:
+    // multiplier for the number of iterations of every case
+    uint32_t scale = 1;
+    // only cases which names contain this string are run
+    std::string filter;
+};
+
+/**
+ * Durations of repeated operations, reported
+ * in microseconds with percentiles
+ */
+class bench_samples {
+    std::vector<double> values;
+
+public:
+    void add(double us);
+
+    void add_since(std::chrono::steady_clock::time_point start);
+
+    void add_all(const bench_samples& other);
+
+    double mean() const;
+
+    sl::json::value to_json() const;
+};
+
+/**
+ * Sets 'wilton_config' environment variable for the engines
+ * created in scope, variable is removed on exit
+ */
+class bench_env_scope {
+    std::string name;
+
+public:
+    bench_env_scope(const std::string& name, const std::string& value);
+
+    ~bench_env_scope();
+
+    bench_env_scope(const bench_env_scope&) = delete;
+
+    bench_env_scope& operator=(const bench_env_scope&) = delete;
+};
+
+typedef std::function<sl::json::value(const bench_options&)> bench_fun;
+
+/**
+ * Registers bench case from the static initializer of a case file
+ */
+class bench_registrar {
+public:
+    bench_registrar(const std::string& name, bench_fun fun);
+};
+
+std::vector<std::pair<std::string, bench_fun>>& bench_cases();
+
+/**
+ * Minimal bootstrap that defines 'WILTON_run', modules are plain scripts that
+ * add their functions to 'BENCH_modules', they are loaded with 'WILTON_load'
+ * on first use. Objects are returned as is when payload is passed as object,
+ * so the result is serialized by the engine.
+ *
+ * @return init code passed to engines
+ */
+const std::string& bench_init_code();
+
+/**
+ * Makes module available to 'WILTON_run' callbacks
+ *
+ * @param name module name used in callbacks
+ * @param code module code
+ */
+void bench_add_module(const std::string& name, std::string code);
+
+/**
+ * @param module module name
+ * @param func function name
+ * @param args JSON array of arguments
+ * @return callback script JSON
+ */
+std::string bench_callback(const std::string& module, const std::string& func,
+        const std::string& args = "[]");
+
+std::unique_ptr<v8eng::v8_engine> bench_create_engine();
+
+/**
+ * Runs callback, its result is discarded, errors are thrown
+ *
+ * @param engine engine
+ * @param callback callback script JSON
+ */
+void bench_run(v8eng::v8_engine& engine, const std::string& callback);
+
+/**
+ * @return resident set size of the process or zero if it is not available
+ */
+uint64_t bench_rss_bytes();
+
+} // namespace
+}
+
+#endif /* WILTON_V8_BENCH_HPP */
+
@@ -0,0 +1,121 @@
+/*
+ * Copyright 2026, agent
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * File:   v8_bench_calls.cpp
+ * Author: agent
+ */
+
+#include <chrono>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "staticlib/json.hpp"
+#include "staticlib/support.hpp"
+
+#include "v8_bench.hpp"
+#include "v8_bench_core_stub.hpp"
+
+namespace wilton {
+namespace v8bench {
+
+namespace { // anonymous
+
+// engine re-checks logger levels once per second
+const std::chrono::milliseconds debug_level_refresh_wait{1100};
+const size_t crossings_per_callback = 1000;
+
+const std::string module_code = std::string() +
+        "BENCH_modules[\"calls\"] = {\n"
+        "    noop: function() {\n"
+        "        return null;\n"
+        "    },\n"
+        "    byName: function(count) {\n"
+        "        for (var i = 0; i < count; i++) {\n"
+        "            WILTON_wiltoncall(\"bench_noop\", \"\");\n"
+        "        }\n"
+        "        return null;\n"
+        "    },\n"
+        "    bound: function(count) {\n"
+        "        var fun = WILTON_wiltoncall_bind(\"bench_noop\");\n"
+        "        for (var i = 0; i < count; i++) {\n"
+        "            fun(\"\");\n"
+        "        }\n"
+        "        return null;\n"
+        "    }\n"
+        "};\n";
+
+sl::json::value measure_callbacks(v8eng::v8_engine& engine, uint32_t count) {
+    auto callback = bench_callback("calls", "noop");
+    auto samples = bench_samples();
+    for (uint32_t i = 0; i < count; i++) {
+        auto start = std::chrono::steady_clock::now();
+        bench_run(engine, callback);
+        samples.add_since(start);
+    }
+    return samples.to_json();
+}
+
+sl::json::value measure_crossings(v8eng::v8_engine& engine, const std::string& func, uint32_t count) {
+    auto callback = bench_callback("calls", func, "[" +
+            sl::support::to_string(crossings_per_callback) + "]");
+    bench_run(engine, callback);
+    auto samples = bench_samples();
+    for (uint32_t i = 0; i < count; i++) {
+        auto start = std::chrono::steady_clock::now();
+        bench_run(engine, callback);
+        auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::steady_clock::now() - start);
+        samples.add(static_cast<double>(elapsed.count()) / 1000 /
+                static_cast<double>(crossings_per_callback));
+    }
+    return samples.to_json();
+}
+
+sl::json::value measure(v8eng::v8_engine& engine, const bench_options& opts) {
+    return {
+        { "callback", measure_callbacks(engine, 10000 * opts.scale) },
+        { "wiltoncall", measure_crossings(engine, "byName", 50 * opts.scale) },
+        { "wiltoncall_bound", measure_crossings(engine, "bound", 50 * opts.scale) }
+    };
+}
+
+// per-call overhead of the engine, with logging disabled the debug messages
+// must not be built, with debug enabled the difference shows their cost
+sl::json::value calls(const bench_options& opts) {
+    bench_add_module("calls", module_code);
+    auto engine = bench_create_engine();
+    bench_run(*engine, bench_callback("calls", "noop"));
+    auto res = std::vector<sl::json::field>();
+    res.emplace_back("debug_off", measure(*engine, opts));
+    stub_set_debug_logging(true);
+    // next cases must not see cached debug level
+    auto deferred = sl::support::defer([] () STATICLIB_NOEXCEPT {
+        stub_set_debug_logging(false);
+        std::this_thread::sleep_for(debug_level_refresh_wait);
+    });
+    std::this_thread::sleep_for(debug_level_refresh_wait);
+    res.emplace_back("debug_on", measure(*engine, opts));
+    return sl::json::value(std::move(res));
+}
+
+bench_registrar calls_registrar("call_overhead", calls);
+
+} // namespace
+
+} // namespace
+}
@@ -0,0 +1,250 @@
+/*
+ * Copyright 2026, agent
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * File:   v8_bench_core_stub.cpp
+ * Author: agent
+ */
+
+#include "v8_bench_core_stub.hpp"
+
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+
+#include "staticlib/json.hpp"
+#include "staticlib/utils.hpp"
+
+#include "wilton/wilton.h"
+#include "wilton/wiltoncall.h"
+#include "wilton/wilton_loader.h"
+#include "wilton/wilton_logging.h"
+
+namespace wilton {
+namespace v8bench {
+
+const std::string stub_base_url = "bench://modules/";
+
+namespace { // anonymous
+
+const std::string file_prefix = "file://";
+
+// built-in calls are checked before registered ones, so
+// the stub adds as little as possible to measured crossings
+const std::string call_echo = "bench_echo";
+const std::string call_noop = "bench_noop";
+const std::string call_fail = "bench_fail";
+
+class registered_call {
+public:
+    void* ctx;
+    wilton_wiltoncall_fun cb;
+};
+
+class core_stub {
+public:
+    std::mutex mutex;
+    std::map<std::string, std::string> env;
+    std::unordered_map<std::string, std::shared_ptr<std::string>> resources;
+    std::unordered_map<std::string, registered_call> calls;
+    std::atomic<bool> debug_logging;
+
+    core_stub() :
+    debug_logging(false) { }
+
+    static core_stub& shared() {
+        static core_stub stub;
+        return stub;
+    }
+};
+
+char* copy_out(const char* data, size_t len) {
+    auto res = wilton_alloc(static_cast<int>(len + 1));
+    std::memcpy(res, data, len);
+    res[len] = '\0';
+    return res;
+}
+
+char* copy_out(const std::string& str) {
+    return copy_out(str.data(), str.length());
+}
+
+} // namespace
+
+void stub_set_env(const std::string& name, const std::string& value) {
+    auto& stub = core_stub::shared();
+    std::lock_guard<std::mutex> guard{stub.mutex};
+    stub.env[name] = value;
+}
+
+void stub_unset_env(const std::string& name) {
+    auto& stub = core_stub::shared();
+    std::lock_guard<std::mutex> guard{stub.mutex};
+    stub.env.erase(name);
+}
+
+void stub_add_resource(const std::string& url, std::string contents) {
+    auto& stub = core_stub::shared();
+    auto res = std::make_shared<std::string>(std::move(contents));
+    std::lock_guard<std::mutex> guard{stub.mutex};
+    stub.resources[url] = std::move(res);
+}
+
+void stub_set_debug_logging(bool enabled) {
+    core_stub::shared().debug_logging.store(enabled, std::memory_order_relaxed);
+}
+
+} // namespace
+}
+
+using wilton::v8bench::core_stub;
+
+char* wilton_alloc(int size_bytes) {
+    auto res = std::malloc(static_cast<size_t>(size_bytes > 0 ? size_bytes : 1));
+    if (nullptr == res) {
+        std::fputs("ERROR: bench stub allocation failed\n", stderr);
+        std::abort();
+    }
+    return static_cast<char*>(res);
+}
+
+void wilton_free(char* buffer) {
+    std::free(buffer);
+}
+
+char* wilton_config(char** conf_json_out, int* conf_json_len_out) {
+    auto& stub = core_stub::shared();
+    auto env = std::vector<sl::json::field>();
+    {
+        std::lock_guard<std::mutex> guard{stub.mutex};
+        for (auto& en : stub.env) {
+            env.emplace_back(en.first, en.second);
+        }
+    }
+    auto json = sl::json::value({
+        { "requireJs", {
+            { "baseUrl", wilton::v8bench::stub_base_url }
+        }},
+        { "environmentVariables", std::move(env) }
+    });
+    auto str = json.dumps();
+    *conf_json_out = wilton::v8bench::copy_out(str);
+    *conf_json_len_out = static_cast<int>(str.length());
+    return nullptr;
+}
+
+char* wilton_register_tls_cleaner(void*, void (*)(void*, const char*, int)) {
+    // bench threads are joined before the engines are destroyed
+    return nullptr;
+}
+
+char* wilton_load_resource(const char* url, int url_len, char** contents_out, int* contents_out_len) {
+    auto& stub = core_stub::shared();
+    auto url_str = std::string(url, static_cast<size_t>(url_len));
+    auto res = std::shared_ptr<std::string>();
+    {
+        std::lock_guard<std::mutex> guard{stub.mutex};
+        auto it = stub.resources.find(url_str);
+        if (stub.resources.end() != it) {
+            res = it->second;
+        }
+    }
+    if (nullptr == res.get() && sl::utils::starts_with(url_str, wilton::v8bench::file_prefix)) {
+        auto path = url_str.substr(wilton::v8bench::file_prefix.length());
+        std::ifstream stream(path, std::ios::in | std::ios::binary);
+        if (stream.is_open()) {
+            res = std::make_shared<std::string>(std::istreambuf_iterator<char>(stream),
+                    std::istreambuf_iterator<char>());
+        }
+    }
+    if (nullptr == res.get()) {
+        return wilton::v8bench::copy_out("Resource not found, url: [" + url_str + "]");
+    }
+    *contents_out = wilton::v8bench::copy_out(*res);
+    *contents_out_len = static_cast<int>(res->length());
+    return nullptr;
+}
+
+char* wiltoncall(const char* call_name, int call_name_len, const char* json_in, int json_in_len,
+        char** json_out, int* json_out_len) {
+    auto len = static_cast<size_t>(call_name_len);
+    if (wilton::v8bench::call_echo.length() == len &&
+            0 == std::memcmp(call_name, wilton::v8bench::call_echo.data(), len)) {
+        *json_out = wilton::v8bench::copy_out(json_in, static_cast<size_t>(json_in_len));
+        *json_out_len = json_in_len;
+        return nullptr;
+    }
+    if (wilton::v8bench::call_noop.length() == len &&
+            0 == std::memcmp(call_name, wilton::v8bench::call_noop.data(), len)) {
+        *json_out = nullptr;
+        *json_out_len = 0;
+        return nullptr;
+    }
+    if (wilton::v8bench::call_fail.length() == len &&
+            0 == std::memcmp(call_name, wilton::v8bench::call_fail.data(), len)) {
+        return wilton::v8bench::copy_out("Bench call failed, input length: [" +
+                sl::support::to_string(json_in_len) + "]");
+    }
+    auto& stub = core_stub::shared();
+    auto name = std::string(call_name, len);
+    auto call = wilton::v8bench::registered_call();
+    {
+        std::lock_guard<std::mutex> guard{stub.mutex};
+        auto it = stub.calls.find(name);
+        if (stub.calls.end() == it) {
+            return wilton::v8bench::copy_out("Call not found, name: [" + name + "]");
+        }
+        call = it->second;
+    }
+    return call.cb(call.ctx, json_in, json_in_len, json_out, json_out_len);
+}
+
+char* wiltoncall_register(const char* call_name, int call_name_len, void* call_ctx,
+        wilton_wiltoncall_fun cb) {
+    auto& stub = core_stub::shared();
+    auto call = wilton::v8bench::registered_call();
+    call.ctx = call_ctx;
+    call.cb = cb;
+    std::lock_guard<std::mutex> guard{stub.mutex};
+    stub.calls[std::string(call_name, static_cast<size_t>(call_name_len))] = call;
+    return nullptr;
+}
+
+char* wilton_logger_log(const char* level_name, int level_name_len, const char* logger_name,
+        int logger_name_len, const char* message, int message_len) {
+    // only problems are reported, stdout is reserved for results
+    auto level = std::string(level_name, static_cast<size_t>(level_name_len));
+    if ("WARN" == level || "ERROR" == level) {
+        std::fprintf(stderr, "%s %.*s: %.*s\n", level.c_str(), logger_name_len, logger_name,
+                message_len, message);
+    }
+    return nullptr;
+}
+
+char* wilton_logger_is_level_enabled(const char*, int, const char* level_name, int level_name_len,
+        int* res_out) {
+    auto level = std::string(level_name, static_cast<size_t>(level_name_len));
+    bool debug = core_stub::shared().debug_logging.load(std::memory_order_relaxed);
+    *res_out = ("DEBUG" == level || "TRACE" == level) ? (debug ? 1 : 0) : 1;
+    return nullptr;
+}
@@ -0,0 +1,72 @@
+/*
+ * Copyright 2026, agent
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * File:   v8_bench_core_stub.hpp
+ * Author: agent
+ */
+
+#ifndef WILTON_V8_BENCH_CORE_STUB_HPP
+#define WILTON_V8_BENCH_CORE_STUB_HPP
+
+#include <string>
+
+namespace wilton {
+namespace v8bench {
+
+/**
+ * Base URL of in-memory modules, passed to engines as 'requireJs.baseUrl'
+ */
+extern const std::string stub_base_url;
+
+/**
+ * Sets environment variable returned by 'wilton_config',
+ * 'V8_*' variables are read by engine initialization
+ *
+ * @param name variable name
+ * @param value variable value
+ */
+void stub_set_env(const std::string& name, const std::string& value);
+
+/**
+ * Removes environment variable returned by 'wilton_config'
+ *
+ * @param name variable name
+ */
+void stub_unset_env(const std::string& name);
+
+/**
+ * Adds in-memory resource returned by 'wilton_load_resource',
+ * other URLs with 'file://' prefix are read from disk
+ *
+ * @param url resource URL
+ * @param contents resource contents
+ */
+void stub_add_resource(const std::string& url, std::string contents);
+
+/**
+ * Sets the result of 'wilton_logger_is_level_enabled' for all loggers,
+ * log messages are discarded regardless of this setting
+ *
+ * @param enabled whether debug level is reported as enabled
+ */
+void stub_set_debug_logging(bool enabled);
+
+} // namespace
+}
+
+#endif /* WILTON_V8_BENCH_CORE_STUB_HPP */
+
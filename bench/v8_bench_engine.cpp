@@ -0,0 +1,213 @@
+/*
+ * Copyright 2026, agent
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * File:   v8_bench_engine.cpp
+ * Author: agent
+ */
+
+#include <chrono>
+#include <string>
+#include <vector>
+
+#include "staticlib/json.hpp"
+#include "staticlib/support.hpp"
+
+#include "v8_bench.hpp"
+#include "v8_bench_core_stub.hpp"
+
+namespace wilton {
+namespace v8bench {
+
+namespace { // anonymous
+
+const std::string module_code = std::string() +
+        "BENCH_modules[\"engine\"] = {\n"
+        "    noop: function() {\n"
+        "        return null;\n"
+        "    },\n"
+        "    crossings: function(name, size, count) {\n"
+        "        var input = new Array(size + 1).join(\"x\");\n"
+        "        for (var i = 0; i < count; i++) {\n"
+        "            WILTON_wiltoncall(name, input);\n"
+        "        }\n"
+        "        return null;\n"
+        "    },\n"
+        "    load: function(url) {\n"
+        "        WILTON_load(url);\n"
+        "        return null;\n"
+        "    },\n"
+        "    garbage: function(count) {\n"
+        "        var list = [];\n"
+        "        for (var i = 0; i < count; i++) {\n"
+        "            list.push({ id: i, name: \"item\" + i, values: [i, i + 1, i + 2] });\n"
+        "            if (list.length >= 1000) {\n"
+        "                list = [];\n"
+        "            }\n"
+        "        }\n"
+        "        return null;\n"
+        "    }\n"
+        "};\n";
+
+// every generated module has unique text, so compilation is not served
+// from the isolate compilation cache
+std::string generate_module(const std::string& name, size_t size) {
+    auto res = std::string();
+    res.reserve(size + 256);
+    res += "// " + name + "\n";
+    res += "BENCH_modules[\"" + name + "\"] = {\n";
+    for (size_t i = 0; res.length() < size; i++) {
+        auto num = sl::support::to_string(i);
+        res += "    f" + num + ": function(a, b) {\n"
+                "        var s = 0;\n"
+                "        for (var j = 0; j < a; j++) {\n"
+                "            s += j * b;\n"
+                "        }\n"
+                "        return s + " + num + ";\n"
+                "    },\n";
+    }
+    res += "    last: null\n};\n";
+    return res;
+}
+
+std::unique_ptr<v8eng::v8_engine> create_engine() {
+    bench_add_module("engine", module_code);
+    auto engine = bench_create_engine();
+    // module is loaded before measurements
+    bench_run(*engine, bench_callback("engine", "noop"));
+    return engine;
+}
+
+sl::json::value construct(const bench_options& opts) {
+    bench_add_module("engine", module_code);
+    auto count = 10 * opts.scale;
+    auto created = bench_samples();
+    auto disposed = bench_samples();
+    auto rss_before = bench_rss_bytes();
+    for (uint32_t i = 0; i < count; i++) {
+        auto start = std::chrono::steady_clock::now();
+        auto engine = bench_create_engine();
+        created.add_since(start);
+        auto start_dispose = std::chrono::steady_clock::now();
+        engine.reset();
+        disposed.add_since(start_dispose);
+    }
+    return {
+        { "construct", created.to_json() },
+        { "dispose", disposed.to_json() },
+        { "rss_growth_bytes", static_cast<int64_t>(bench_rss_bytes()) - static_cast<int64_t>(rss_before) }
+    };
+}
+
+sl::json::value roundtrip(const bench_options& opts) {
+    auto engine = create_engine();
+    auto callback = bench_callback("engine", "noop");
+    for (size_t i = 0; i < 100; i++) {
+        bench_run(*engine, callback);
+    }
+    auto count = 10000 * opts.scale;
+    auto samples = bench_samples();
+    for (uint32_t i = 0; i < count; i++) {
+        auto start = std::chrono::steady_clock::now();
+        bench_run(*engine, callback);
+        samples.add_since(start);
+    }
+    return {
+        { "callback", samples.to_json() }
+    };
+}
+
+sl::json::value crossings(const bench_options& opts) {
+    auto engine = create_engine();
+    auto sizes = std::vector<size_t>{16, 1024, 16384, 262144};
+    auto res = std::vector<sl::json::field>();
+    for (size_t size : sizes) {
+        // per crossing times, fewer crossings for large payloads
+        size_t per_callback = size > 16384 ? 100 : 1000;
+        auto callback = bench_callback("engine", "crossings", "[\"bench_echo\", " +
+                sl::support::to_string(size) + ", " + sl::support::to_string(per_callback) + "]");
+        bench_run(*engine, callback);
+        auto samples = bench_samples();
+        auto count = 20 * opts.scale;
+        for (uint32_t i = 0; i < count; i++) {
+            auto start = std::chrono::steady_clock::now();
+            bench_run(*engine, callback);
+            auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                    std::chrono::steady_clock::now() - start);
+            samples.add(static_cast<double>(elapsed.count()) / 1000 / static_cast<double>(per_callback));
+        }
+        res.emplace_back(sl::support::to_string(size), samples.to_json());
+    }
+    return sl::json::value(std::move(res));
+}
+
+sl::json::value load(const bench_options& opts) {
+    auto engine = create_engine();
+    auto sizes = std::vector<size_t>{16 * 1024, 256 * 1024, 2 * 1024 * 1024};
+    auto res = std::vector<sl::json::field>();
+    for (size_t size : sizes) {
+        auto samples = bench_samples();
+        auto count = 5 * opts.scale;
+        for (uint32_t i = 0; i < count; i++) {
+            auto name = "gen_" + sl::support::to_string(size) + "_" + sl::support::to_string(i);
+            auto url = stub_base_url + name + ".js";
+            stub_add_resource(url, generate_module(name, size));
+            auto callback = bench_callback("engine", "load", "[" + sl::json::value(url).dumps() + "]");
+            auto start = std::chrono::steady_clock::now();
+            bench_run(*engine, callback);
+            samples.add_since(start);
+        }
+        auto mean_us = samples.mean();
+        auto mb_per_s = mean_us > 0 ? static_cast<double>(size) / (1024 * 1024) / (mean_us / 1000000) : 0.0;
+        res.emplace_back(sl::support::to_string(size), sl::json::value({
+            { "load", samples.to_json() },
+            { "mb_per_s", mb_per_s }
+        }));
+    }
+    return sl::json::value(std::move(res));
+}
+
+sl::json::value gc(const bench_options& opts) {
+    auto engine = create_engine();
+    auto callback = bench_callback("engine", "garbage", "[20000]");
+    auto allocated = bench_samples();
+    auto collected = bench_samples();
+    auto count = 20 * opts.scale;
+    for (uint32_t i = 0; i < count; i++) {
+        auto start = std::chrono::steady_clock::now();
+        bench_run(*engine, callback);
+        allocated.add_since(start);
+        auto start_gc = std::chrono::steady_clock::now();
+        engine->run_garbage_collector();
+        collected.add_since(start_gc);
+    }
+    return {
+        { "allocate_callback", allocated.to_json() },
+        { "run_garbage_collector", collected.to_json() },
+        { "rss_bytes", static_cast<int64_t>(bench_rss_bytes()) }
+    };
+}
+
+bench_registrar construct_registrar("engine_construct", construct);
+bench_registrar roundtrip_registrar("engine_callback_roundtrip", roundtrip);
+bench_registrar crossings_registrar("engine_wiltoncall_crossings", crossings);
+bench_registrar load_registrar("engine_load_compile", load);
+bench_registrar gc_registrar("engine_gc", gc);
+
+} // namespace
+
+} // namespace
+}
@@ -0,0 +1,141 @@
+/*
+ * Copyright 2026, agent
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * File:   v8_bench_errors.cpp
+ * Author: agent
+ */
+
+#include <chrono>
+#include <exception>
+#include <string>
+#include <vector>
+
+#include "staticlib/json.hpp"
+#include "staticlib/support.hpp"
+
+#include "v8_bench.hpp"
+
+namespace wilton {
+namespace v8bench {
+
+namespace { // anonymous
+
+const size_t errors_per_callback = 1000;
+
+// validation-like control flow, errors are raised and caught in a loop
+const std::string module_code = std::string() +
+        "BENCH_modules[\"errors\"] = {\n"
+        "    noop: function() {\n"
+        "        return null;\n"
+        "    },\n"
+        "    nativeCaught: function(count) {\n"
+        "        for (var i = 0; i < count; i++) {\n"
+        "            try {\n"
+        "                WILTON_wiltoncall(\"bench_fail\", \"\");\n"
+        "            } catch (e) {\n"
+        "            }\n"
+        "        }\n"
+        "        return null;\n"
+        "    },\n"
+        "    nativeMessage: function(count) {\n"
+        "        var len = 0;\n"
+        "        for (var i = 0; i < count; i++) {\n"
+        "            try {\n"
+        "                WILTON_wiltoncall(\"bench_fail\", \"\");\n"
+        "            } catch (e) {\n"
+        "                len += e.message.length;\n"
+        "            }\n"
+        "        }\n"
+        "        return len;\n"
+        "    },\n"
+        "    nativeSerialized: function(count) {\n"
+        "        var len = 0;\n"
+        "        for (var i = 0; i < count; i++) {\n"
+        "            try {\n"
+        "                WILTON_wiltoncall(\"bench_fail\", \"\");\n"
+        "            } catch (e) {\n"
+        "                len += JSON.stringify(e).length;\n"
+        "            }\n"
+        "        }\n"
+        "        return len;\n"
+        "    },\n"
+        "    jsCaught: function(count) {\n"
+        "        for (var i = 0; i < count; i++) {\n"
+        "            try {\n"
+        "                throw new Error(\"Validation failed\");\n"
+        "            } catch (e) {\n"
+        "            }\n"
+        "        }\n"
+        "        return null;\n"
+        "    },\n"
+        "    fail: function() {\n"
+        "        throw new Error(\"Callback failed\");\n"
+        "    }\n"
+        "};\n";
+
+sl::json::value measure_in_js(v8eng::v8_engine& engine, const std::string& func, uint32_t count) {
+    auto callback = bench_callback("errors", func, "[" +
+            sl::support::to_string(errors_per_callback) + "]");
+    bench_run(engine, callback);
+    auto samples = bench_samples();
+    for (uint32_t i = 0; i < count; i++) {
+        auto start = std::chrono::steady_clock::now();
+        bench_run(engine, callback);
+        auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::steady_clock::now() - start);
+        samples.add(static_cast<double>(elapsed.count()) / 1000 /
+                static_cast<double>(errors_per_callback));
+    }
+    return samples.to_json();
+}
+
+// uncaught errors go through stack trace formatting into native exception
+sl::json::value measure_failed_callbacks(v8eng::v8_engine& engine, uint32_t count) {
+    auto callback = bench_callback("errors", "fail");
+    auto samples = bench_samples();
+    for (uint32_t i = 0; i < count; i++) {
+        auto start = std::chrono::steady_clock::now();
+        try {
+            bench_run(engine, callback);
+        } catch (const std::exception&) {
+            // expected
+        }
+        samples.add_since(start);
+    }
+    return samples.to_json();
+}
+
+sl::json::value errors(const bench_options& opts) {
+    bench_add_module("errors", module_code);
+    auto engine = bench_create_engine();
+    bench_run(*engine, bench_callback("errors", "noop"));
+    auto count = 20 * opts.scale;
+    return {
+        { "native_error_caught", measure_in_js(*engine, "nativeCaught", count) },
+        { "native_error_message", measure_in_js(*engine, "nativeMessage", count) },
+        { "native_error_serialized", measure_in_js(*engine, "nativeSerialized", count) },
+        { "js_error_caught", measure_in_js(*engine, "jsCaught", count) },
+        { "failed_callback", measure_failed_callbacks(*engine, 1000 * opts.scale) }
+    };
+}
+
+bench_registrar errors_registrar("error_paths", errors);
+
+} // namespace
+
+} // namespace
+}
@@ -0,0 +1,107 @@
+/*
+ * Copyright 2026, agent
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * File:   v8_bench_main.cpp
+ * Author: agent
+ */
+
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "v8.h"
+
+#include "staticlib/json.hpp"
+#include "staticlib/support.hpp"
+#include "staticlib/utils.hpp"
+
+#include "v8_bench.hpp"
+#include "v8_bench_core_stub.hpp"
+#include "v8_engine.hpp"
+
+namespace { // anonymous
+
+const char* usage = "Usage: wilton_v8_bench [--scale N] [--filter NAME] [--env V8_NAME=VALUE ...]\n"
+        "Runs V8 engine benchmarks against the stub of wilton core, results are printed as JSON,\n"
+        "'--env' options are passed to the engine as 'wilton_config' environment variables\n";
+
+wilton::v8bench::bench_options parse_args(int argc, char** argv) {
+    auto res = wilton::v8bench::bench_options();
+    for (int i = 1; i < argc; i++) {
+        auto arg = std::string(argv[i]);
+        if (i + 1 >= argc) {
+            throw sl::support::exception(std::string() + "Invalid arguments\n" + usage);
+        }
+        auto val = std::string(argv[++i]);
+        if ("--scale" == arg) {
+            res.scale = sl::utils::parse_uint32(val);
+        } else if ("--filter" == arg) {
+            res.filter = val;
+        } else if ("--env" == arg) {
+            auto eq = val.find('=');
+            if (std::string::npos == eq) {
+                throw sl::support::exception("Invalid '--env' option: [" + val + "]");
+            }
+            wilton::v8bench::stub_set_env(val.substr(0, eq), val.substr(eq + 1));
+        } else {
+            throw sl::support::exception(std::string() + "Invalid argument: [" + arg + "]\n" + usage);
+        }
+    }
+    return res;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    if (argc > 1 && (0 == std::strcmp("-h", argv[1]) || 0 == std::strcmp("--help", argv[1]))) {
+        std::fputs(usage, stdout);
+        return 0;
+    }
+    try {
+        auto opts = parse_args(argc, argv);
+        wilton::v8eng::v8_engine::initialize();
+        auto cases = std::vector<sl::json::field>();
+        bool failed = false;
+        for (auto& en : wilton::v8bench::bench_cases()) {
+            if (!opts.filter.empty() && std::string::npos == en.first.find(opts.filter)) {
+                continue;
+            }
+            std::fprintf(stderr, "Running case: [%s] ...\n", en.first.c_str());
+            try {
+                cases.emplace_back(en.first, en.second(opts));
+            } catch (const std::exception& e) {
+                failed = true;
+                cases.emplace_back(en.first, sl::json::value({
+                    { "error", std::string(e.what()) }
+                }));
+            }
+        }
+        auto res = sl::json::value({
+            { "v8_version", std::string(v8::V8::GetVersion()) },
+            { "scale", static_cast<int64_t>(opts.scale) },
+            { "cases", std::move(cases) },
+            { "stats", wilton::v8eng::v8_engine::stats() }
+        });
+        std::cout << res.dumps() << std::endl;
+        return failed ? 1 : 0;
+    } catch (const std::exception& e) {
+        std::cerr << e.what() << std::endl;
+        return 1;
+    }
+}
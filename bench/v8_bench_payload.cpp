@@ -0,0 +1,108 @@
+/*
+ * Copyright 2026, agent
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * File:   v8_bench_payload.cpp
+ * Author: agent
+ */
+
+#include <chrono>
+#include <string>
+#include <vector>
+
+#include "staticlib/json.hpp"
+#include "staticlib/support.hpp"
+
+#include "v8_bench.hpp"
+
+namespace wilton {
+namespace v8bench {
+
+namespace { // anonymous
+
+const std::string module_code = std::string() +
+        "BENCH_modules[\"payload\"] = {\n"
+        "    noop: function() {\n"
+        "        return null;\n"
+        "    },\n"
+        "    handle: function(req) {\n"
+        "        return { id: req.id, status: \"ok\", count: req.items.length };\n"
+        "    }\n"
+        "};\n";
+
+std::string request_json(size_t items_count) {
+    auto items = std::vector<sl::json::value>();
+    for (size_t i = 0; i < items_count; i++) {
+        items.emplace_back(sl::json::value({
+            { "id", static_cast<int64_t>(i) },
+            { "name", "item_" + sl::support::to_string(i) }
+        }));
+    }
+    auto req = sl::json::value({
+        { "id", static_cast<int64_t>(42) },
+        { "user", "bench" },
+        { "items", std::move(items) }
+    });
+    return "[" + req.dumps() + "]";
+}
+
+sl::json::value measure(uint32_t count) {
+    auto engine = bench_create_engine();
+    bench_run(*engine, bench_callback("payload", "noop"));
+    auto sizes = std::vector<size_t>{1, 10, 100};
+    auto res = std::vector<sl::json::field>();
+    for (size_t items_count : sizes) {
+        auto callback = bench_callback("payload", "handle", request_json(items_count));
+        for (size_t i = 0; i < 100; i++) {
+            bench_run(*engine, callback);
+        }
+        auto samples = bench_samples();
+        for (uint32_t i = 0; i < count; i++) {
+            auto start = std::chrono::steady_clock::now();
+            bench_run(*engine, callback);
+            samples.add_since(start);
+        }
+        res.emplace_back("items_" + sl::support::to_string(items_count), sl::json::value({
+            { "callback_bytes", static_cast<int64_t>(callback.length()) },
+            { "callback", samples.to_json() }
+        }));
+    }
+    return sl::json::value(std::move(res));
+}
+
+// call-heavy workload with small payloads, the bootstrap parses and
+// serializes JSON in JS for strings, engine does it for objects
+sl::json::value payload(const bench_options& opts) {
+    bench_add_module("payload", module_code);
+    auto count = 10000 * opts.scale;
+    auto res = std::vector<sl::json::field>();
+    {
+        bench_env_scope env("V8_callback_payload_objects", "false");
+        res.emplace_back("strings", measure(count));
+    }
+    {
+        bench_env_scope env("V8_callback_payload_objects", "true");
+        res.emplace_back("objects", measure(count));
+    }
+    return sl::json::value(std::move(res));
+}
+
+bench_registrar payload_registrar("callback_payloads", payload);
+
+} // namespace
+
+} // namespace
+}
@@ -0,0 +1,167 @@
+/*
+ * Copyright 2026, agent
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * File:   v8_bench_pool.cpp
+ * Author: agent
+ */
+
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "staticlib/json.hpp"
+#include "staticlib/support.hpp"
+
+#include "v8_engine_pool.hpp"
+
+#include "v8_bench.hpp"
+
+namespace wilton {
+namespace v8bench {
+
+namespace { // anonymous
+
+const size_t threads_count = 16;
+const size_t pool_size = 4;
+
+const std::string module_code = std::string() +
+        "BENCH_modules[\"pool\"] = {\n"
+        "    noop: function() {\n"
+        "        return null;\n"
+        "    },\n"
+        "    work: function(count) {\n"
+        "        var list = [];\n"
+        "        for (var i = 0; i < count; i++) {\n"
+        "            list.push({ id: i, name: \"item\" + i });\n"
+        "        }\n"
+        "        return list.length;\n"
+        "    }\n"
+        "};\n";
+
+/**
+ * Runs the same calls from all threads, memory is sampled
+ * while all thread engines are still alive
+ */
+class thread_group {
+    std::mutex mutex;
+    std::condition_variable cv;
+    size_t finished = 0;
+    bool released = false;
+    std::vector<bench_samples> samples;
+
+public:
+    explicit thread_group(size_t count) :
+    samples(count) { }
+
+    // 'call' runs a callback, 'setup' is done once on thread start
+    sl::json::value run(uint32_t calls_per_thread,
+            std::function<std::function<void()>()> setup) {
+        auto rss_before = bench_rss_bytes();
+        auto threads = std::vector<std::thread>();
+        auto start = std::chrono::steady_clock::now();
+        for (size_t i = 0; i < samples.size(); i++) {
+            threads.emplace_back([this, i, calls_per_thread, setup] {
+                run_thread(samples.at(i), calls_per_thread, setup);
+            });
+        }
+        uint64_t rss = 0;
+        {
+            std::unique_lock<std::mutex> guard{mutex};
+            cv.wait(guard, [this] {
+                return finished == samples.size();
+            });
+            rss = bench_rss_bytes();
+            released = true;
+        }
+        auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(
+                std::chrono::steady_clock::now() - start);
+        cv.notify_all();
+        for (auto& th : threads) {
+            th.join();
+        }
+        auto merged = bench_samples();
+        for (auto& sa : samples) {
+            merged.add_all(sa);
+        }
+        auto total = static_cast<double>(calls_per_thread) * static_cast<double>(samples.size());
+        auto secs = static_cast<double>(elapsed.count()) / 1000000;
+        return {
+            { "threads", static_cast<int64_t>(samples.size()) },
+            { "calls_per_s", secs > 0 ? total / secs : 0.0 },
+            { "call", merged.to_json() },
+            { "rss_growth_bytes", static_cast<int64_t>(rss) - static_cast<int64_t>(rss_before) }
+        };
+    }
+
+private:
+    void run_thread(bench_samples& sa, uint32_t count, std::function<std::function<void()>()> setup) {
+        // thread-local engine lives until memory is sampled
+        auto call = setup();
+        for (uint32_t i = 0; i < count; i++) {
+            auto start = std::chrono::steady_clock::now();
+            call();
+            sa.add_since(start);
+        }
+        std::unique_lock<std::mutex> guard{mutex};
+        finished += 1;
+        cv.notify_all();
+        cv.wait(guard, [this] {
+            return released;
+        });
+    }
+};
+
+sl::json::value pool(const bench_options& opts) {
+    bench_add_module("pool", module_code);
+    auto callback = bench_callback("pool", "work", "[100]");
+    auto calls = 200 * opts.scale;
+    auto res = std::vector<sl::json::field>();
+    {
+        thread_group group(threads_count);
+        res.emplace_back("thread_local", group.run(calls, [&callback] {
+            auto engine = std::shared_ptr<v8eng::v8_engine>(bench_create_engine().release());
+            return std::function<void()>([engine, &callback] {
+                bench_run(*engine, callback);
+            });
+        }));
+    }
+    {
+        auto pl = std::make_shared<v8eng::v8_engine_pool>(pool_size, 0);
+        pl->set_init_code(std::make_shared<const std::string>(bench_init_code()));
+        thread_group group(threads_count);
+        auto measured = group.run(calls, [pl, &callback] {
+            return std::function<void()>([pl, &callback] {
+                pl->run_script({callback.data(), callback.length()});
+            });
+        });
+        measured.as_object_or_throw().emplace_back("pool", pl->stats());
+        res.emplace_back("pool", std::move(measured));
+    }
+    return sl::json::value(std::move(res));
+}
+
+bench_registrar pool_registrar("pool_vs_thread_local", pool);
+
+} // namespace
+
+} // namespace
+}
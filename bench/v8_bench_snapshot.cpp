@@ -0,0 +1,87 @@
+/*
+ * Copyright 2026, agent
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * File:   v8_bench_snapshot.cpp
+ * Author: agent
+ */
+
+#include <chrono>
+#include <string>
+#include <vector>
+
+#include "staticlib/json.hpp"
+
+#include "v8_bench.hpp"
+
+namespace wilton {
+namespace v8bench {
+
+namespace { // anonymous
+
+const std::string module_code = std::string() +
+        "BENCH_modules[\"snapshot\"] = {\n"
+        "    noop: function() {\n"
+        "        return null;\n"
+        "    }\n"
+        "};\n";
+
+// time to a first served callback is measured, deserialized
+// context may defer some of the work until first use
+sl::json::value construct(uint32_t count) {
+    auto created = bench_samples();
+    auto first_callback = bench_samples();
+    auto callback = bench_callback("snapshot", "noop");
+    for (uint32_t i = 0; i < count; i++) {
+        auto start = std::chrono::steady_clock::now();
+        auto engine = bench_create_engine();
+        created.add_since(start);
+        auto start_callback = std::chrono::steady_clock::now();
+        bench_run(*engine, callback);
+        first_callback.add_since(start_callback);
+    }
+    return {
+        { "construct", created.to_json() },
+        { "first_callback", first_callback.to_json() }
+    };
+}
+
+sl::json::value snapshot(const bench_options& opts) {
+    bench_add_module("snapshot", module_code);
+    auto count = 20 * opts.scale;
+    auto res = std::vector<sl::json::field>();
+    {
+        bench_env_scope env("V8_startup_snapshot", "false");
+        res.emplace_back("snapshot_off", construct(count));
+    }
+    bench_env_scope env("V8_startup_snapshot", "true");
+    // blob is created once per process by the first engine that uses it
+    auto blob_samples = bench_samples();
+    auto start = std::chrono::steady_clock::now();
+    auto engine = bench_create_engine();
+    blob_samples.add_since(start);
+    engine.reset();
+    res.emplace_back("first_construct_with_blob_creation", blob_samples.to_json());
+    res.emplace_back("snapshot_on", construct(count));
+    return sl::json::value(std::move(res));
+}
+
+bench_registrar snapshot_registrar("snapshot_isolate_creation", snapshot);
+
+} // namespace
+
+} // namespace
+}
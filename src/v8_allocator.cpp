@@ -0,0 +1,282 @@
+/*
+ * Copyright 2026, agent
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * File:   v8_allocator.cpp
+ * Author: agent
+ */
+
+#include "v8_allocator.hpp"
+
+#include <array>
+#include <cstdlib>
+#include <cstring>
+#include <mutex>
+#include <vector>
+
+namespace wilton {
+namespace v8eng {
+
+namespace { // anonymous
+
+const size_t min_class_size = 64;
+const size_t size_classes_count = 15;
+// 1MB, larger buffers are not pooled
+const size_t max_class_size = min_class_size << (size_classes_count - 1);
+// fraction of the budget after which GC is requested
+const uint64_t gc_threshold_percent = 90;
+const std::chrono::milliseconds gc_request_interval{100};
+
+// keeps user data aligned to 16 bytes
+class block_header {
+public:
+    v8_allocation_counters* counters;
+    size_t length;
+};
+
+const size_t header_size = 16;
+
+static_assert(sizeof(block_header) <= header_size, "Unexpected allocation header size");
+
+thread_local v8_allocation_counters* current_counters = nullptr;
+thread_local v8::Isolate* current_isolate = nullptr;
+
+size_t class_index(size_t length) {
+    size_t idx = 0;
+    size_t size = min_class_size;
+    while (size < length) {
+        size <<= 1;
+        idx += 1;
+    }
+    return idx;
+}
+
+size_t class_size(size_t idx) {
+    return min_class_size << idx;
+}
+
+void request_gc_interrupt(v8::Isolate* isolate, void* data) {
+    auto counters = static_cast<v8_allocation_counters*>(data);
+    isolate->MemoryPressureNotification(v8::MemoryPressureLevel::kCritical);
+    counters->gc_requested.store(false, std::memory_order_relaxed);
+}
+
+class pooled_allocator : public v8::ArrayBuffer::Allocator {
+    class free_list {
+    public:
+        std::mutex mutex;
+        std::vector<void*> blocks;
+    };
+
+    std::array<free_list, size_classes_count> free_lists;
+    // not attributed to any engine
+    v8_allocation_counters detached;
+
+public:
+    std::atomic<uint64_t> budget_bytes;
+    std::atomic<uint64_t> pool_limit_bytes;
+    std::atomic<uint64_t> live_bytes;
+    std::atomic<uint64_t> peak_bytes;
+    std::atomic<uint64_t> pooled_bytes;
+    std::atomic<uint64_t> pool_hits;
+    std::atomic<uint64_t> pool_misses;
+    std::atomic<uint64_t> failures;
+
+    pooled_allocator() :
+    budget_bytes(0),
+    pool_limit_bytes(64 * 1024 * 1024),
+    live_bytes(0),
+    peak_bytes(0),
+    pooled_bytes(0),
+    pool_hits(0),
+    pool_misses(0),
+    failures(0) { }
+
+    void* Allocate(size_t length) override {
+        return allocate(length, true);
+    }
+
+    // V8 calls it when it is going to overwrite the contents anyway
+    void* AllocateUninitialized(size_t length) override {
+        return allocate(length, false);
+    }
+
+    void Free(void* data, size_t) override {
+        if (nullptr == data) {
+            return;
+        }
+        auto block = static_cast<char*>(data) - header_size;
+        auto header = reinterpret_cast<block_header*>(block);
+        auto length = header->length;
+        live_bytes.fetch_sub(length, std::memory_order_relaxed);
+        header->counters->live_bytes.fetch_sub(length, std::memory_order_relaxed);
+        header->counters->release();
+        if (length <= max_class_size) {
+            auto idx = class_index(length);
+            auto size = class_size(idx);
+            if (pooled_bytes.load(std::memory_order_relaxed) + size <= pool_limit_bytes.load(std::memory_order_relaxed)) {
+                auto& fl = free_lists[idx];
+                std::lock_guard<std::mutex> guard{fl.mutex};
+                fl.blocks.push_back(block);
+                pooled_bytes.fetch_add(size, std::memory_order_relaxed);
+                return;
+            }
+        }
+        std::free(block);
+    }
+
+private:
+    void* allocate(size_t length, bool zeroed) {
+        auto budget = budget_bytes.load(std::memory_order_relaxed);
+        if (budget > 0) {
+            auto live = live_bytes.load(std::memory_order_relaxed);
+            if (live + length > budget) {
+                failures.fetch_add(1, std::memory_order_relaxed);
+                request_gc();
+                return nullptr;
+            }
+            if ((live + length) * 100 > budget * gc_threshold_percent) {
+                request_gc();
+            }
+        }
+        auto block = take_block(length);
+        if (nullptr == block) {
+            failures.fetch_add(1, std::memory_order_relaxed);
+            return nullptr;
+        }
+        auto data = block + header_size;
+        if (zeroed && length > 0) {
+            std::memset(data, 0, length);
+        }
+        auto counters = nullptr != current_counters ? current_counters : std::addressof(detached);
+        counters->acquire();
+        counters->live_bytes.fetch_add(length, std::memory_order_relaxed);
+        counters->allocations.fetch_add(1, std::memory_order_relaxed);
+        auto header = reinterpret_cast<block_header*>(block);
+        header->counters = counters;
+        header->length = length;
+        auto live = live_bytes.fetch_add(length, std::memory_order_relaxed) + length;
+        auto peak = peak_bytes.load(std::memory_order_relaxed);
+        while (live > peak && !peak_bytes.compare_exchange_weak(peak, live, std::memory_order_relaxed));
+        return data;
+    }
+
+    char* take_block(size_t length) {
+        if (length <= max_class_size) {
+            auto idx = class_index(length);
+            auto& fl = free_lists[idx];
+            {
+                std::lock_guard<std::mutex> guard{fl.mutex};
+                if (!fl.blocks.empty()) {
+                    auto block = fl.blocks.back();
+                    fl.blocks.pop_back();
+                    pooled_bytes.fetch_sub(class_size(idx), std::memory_order_relaxed);
+                    pool_hits.fetch_add(1, std::memory_order_relaxed);
+                    return static_cast<char*>(block);
+                }
+            }
+            pool_misses.fetch_add(1, std::memory_order_relaxed);
+            return static_cast<char*>(std::malloc(header_size + class_size(idx)));
+        }
+        return static_cast<char*>(std::malloc(header_size + length));
+    }
+
+    // GC cannot be run from inside the allocation, so it is requested
+    // through the interrupt that is handled by the isolate at a safe point
+    void request_gc() {
+        auto counters = current_counters;
+        auto isolate = current_isolate;
+        if (nullptr == counters || nullptr == isolate) {
+            return;
+        }
+        auto now = std::chrono::steady_clock::now();
+        if (now - counters->last_gc_request < gc_request_interval) {
+            return;
+        }
+        bool expected = false;
+        if (counters->gc_requested.compare_exchange_strong(expected, true, std::memory_order_relaxed)) {
+            counters->last_gc_request = now;
+            isolate->RequestInterrupt(request_gc_interrupt, counters);
+        }
+    }
+};
+
+pooled_allocator& shared_allocator() {
+    // never freed, isolates may outlive static destructors
+    static pooled_allocator* allocator = new pooled_allocator();
+    return *allocator;
+}
+
+sl::json::value json_u64(uint64_t num) {
+    return sl::json::value(static_cast<int64_t>(num));
+}
+
+} // namespace
+
+v8_allocation_counters::v8_allocation_counters() :
+refs(1),
+live_bytes(0),
+allocations(0),
+gc_requested(false) { }
+
+void v8_allocation_counters::acquire() STATICLIB_NOEXCEPT {
+    refs.fetch_add(1, std::memory_order_relaxed);
+}
+
+void v8_allocation_counters::release() STATICLIB_NOEXCEPT {
+    if (1 == refs.fetch_sub(1, std::memory_order_acq_rel)) {
+        delete this;
+    }
+}
+
+v8_allocation_scope::v8_allocation_scope(v8_allocation_counters* counters, v8::Isolate* isolate) :
+prev_counters(current_counters),
+prev_isolate(current_isolate) {
+    current_counters = counters;
+    current_isolate = isolate;
+}
+
+v8_allocation_scope::~v8_allocation_scope() STATICLIB_NOEXCEPT {
+    current_counters = prev_counters;
+    current_isolate = prev_isolate;
+}
+
+v8::ArrayBuffer::Allocator* shared_array_buffer_allocator() {
+    return std::addressof(shared_allocator());
+}
+
+void configure_array_buffer_allocator(uint64_t budget_bytes, uint64_t pool_bytes) {
+    auto& al = shared_allocator();
+    al.budget_bytes.store(budget_bytes, std::memory_order_relaxed);
+    al.pool_limit_bytes.store(pool_bytes, std::memory_order_relaxed);
+}
+
+sl::json::value array_buffer_allocator_stats() {
+    auto& al = shared_allocator();
+    return {
+        { "budget_bytes", json_u64(al.budget_bytes.load()) },
+        { "live_bytes", json_u64(al.live_bytes.load()) },
+        { "peak_bytes", json_u64(al.peak_bytes.load()) },
+        { "pooled_bytes", json_u64(al.pooled_bytes.load()) },
+        { "pool_limit_bytes", json_u64(al.pool_limit_bytes.load()) },
+        { "pool_hits", json_u64(al.pool_hits.load()) },
+        { "pool_misses", json_u64(al.pool_misses.load()) },
+        { "failures", json_u64(al.failures.load()) }
+    };
+}
+
+} // namespace
+}
@@ -0,0 +1,103 @@
+/*
+ * Copyright 2026, agent
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * File:   v8_allocator.hpp
+ * Author: agent
+ */
+
+#ifndef WILTON_V8_ALLOCATOR_HPP
+#define WILTON_V8_ALLOCATOR_HPP
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+#include "v8.h"
+
+#include "staticlib/config.hpp"
+#include "staticlib/json.hpp"
+
+namespace wilton {
+namespace v8eng {
+
+/**
+ * Off-heap memory accounting of a single engine, each live
+ * backing store holds a reference, so counters may outlive the engine
+ */
+class v8_allocation_counters {
+    std::atomic<size_t> refs;
+
+public:
+    std::atomic<uint64_t> live_bytes;
+    std::atomic<uint64_t> allocations;
+    // used only from the engine thread
+    std::atomic<bool> gc_requested;
+    std::chrono::steady_clock::time_point last_gc_request;
+
+    v8_allocation_counters();
+
+    v8_allocation_counters(const v8_allocation_counters&) = delete;
+
+    v8_allocation_counters& operator=(const v8_allocation_counters&) = delete;
+
+    void acquire() STATICLIB_NOEXCEPT;
+
+    void release() STATICLIB_NOEXCEPT;
+};
+
+/**
+ * Attributes allocations made on the current thread to the specified
+ * engine, must be active while the isolate is entered
+ */
+class v8_allocation_scope {
+    v8_allocation_counters* prev_counters;
+    v8::Isolate* prev_isolate;
+
+public:
+    v8_allocation_scope(v8_allocation_counters* counters, v8::Isolate* isolate);
+
+    ~v8_allocation_scope() STATICLIB_NOEXCEPT;
+
+    v8_allocation_scope(const v8_allocation_scope&) = delete;
+
+    v8_allocation_scope& operator=(const v8_allocation_scope&) = delete;
+};
+
+/**
+ * ArrayBuffer allocator shared by all isolates in the process, backing
+ * stores transferred between isolates are released through it
+ *
+ * @return process-wide allocator
+ */
+v8::ArrayBuffer::Allocator* shared_array_buffer_allocator();
+
+/**
+ * Sets limits of the shared allocator, must be called before
+ * the first engine is created
+ *
+ * @param budget_bytes max off-heap bytes for all engines, 0 for no limit
+ * @param pool_bytes max bytes kept in free lists for reuse
+ */
+void configure_array_buffer_allocator(uint64_t budget_bytes, uint64_t pool_bytes);
+
+sl::json::value array_buffer_allocator_stats();
+
+} // namespace
+}
+
+#endif /* WILTON_V8_ALLOCATOR_HPP */
+
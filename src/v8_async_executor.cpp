@@ -0,0 +1,177 @@
+/*
+ * Copyright 2026, agent
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * File:   v8_async_executor.cpp
+ * Author: agent
+ */
+
+#include "v8_async_executor.hpp"
+
+#include "staticlib/support.hpp"
+
+#include "wilton/wiltoncall.h"
+
+#include "wilton/support/logging.hpp"
+
+namespace wilton {
+namespace v8eng {
+
+namespace { // anonymous
+
+thread_local bool worker_thread = false;
+
+} // namespace
+
+void v8_completion_queue::post(v8_async_completion completion) {
+    {
+        std::lock_guard<std::mutex> guard{mutex};
+        completions.emplace_back(std::move(completion));
+    }
+    cv.notify_all();
+}
+
+std::vector<v8_async_completion> v8_completion_queue::take_all(bool wait,
+        std::chrono::steady_clock::time_point deadline) {
+    std::unique_lock<std::mutex> guard{mutex};
+    auto has_work = [this] {
+        return interrupted || !completions.empty();
+    };
+    if (wait && std::chrono::steady_clock::time_point::max() == deadline) {
+        cv.wait(guard, has_work);
+    } else if (wait) {
+        cv.wait_until(guard, deadline, has_work);
+    }
+    auto res = std::vector<v8_async_completion>();
+    while (!completions.empty()) {
+        res.emplace_back(std::move(completions.front()));
+        completions.pop_front();
+    }
+    return res;
+}
+
+void v8_completion_queue::interrupt() {
+    {
+        std::lock_guard<std::mutex> guard{mutex};
+        interrupted = true;
+    }
+    cv.notify_all();
+}
+
+bool v8_completion_queue::is_interrupted() {
+    std::lock_guard<std::mutex> guard{mutex};
+    return interrupted;
+}
+
+void v8_completion_queue::clear_interrupt() {
+    std::lock_guard<std::mutex> guard{mutex};
+    interrupted = false;
+}
+
+v8_async_executor::v8_async_executor(size_t threads_count) :
+threads_count(threads_count > 0 ? threads_count : 1) { }
+
+v8_async_executor::~v8_async_executor() STATICLIB_NOEXCEPT {
+    {
+        std::lock_guard<std::mutex> guard{mutex};
+        stopping = true;
+    }
+    cv.notify_all();
+    for (auto& th : workers) {
+        th.join();
+    }
+}
+
+void v8_async_executor::submit(std::function<void()> task) {
+    {
+        std::lock_guard<std::mutex> guard{mutex};
+        if (workers.empty()) {
+            for (size_t i = 0; i < threads_count; i++) {
+                workers.emplace_back(&v8_async_executor::run_worker, this);
+            }
+        }
+        tasks.emplace_back(std::move(task));
+    }
+    cv.notify_one();
+}
+
+void v8_async_executor::submit_wiltoncall(std::shared_ptr<v8_completion_queue> queue, uint64_t id,
+        std::string name, std::string input) {
+    // C++11 lambdas cannot move-capture, arguments are shared instead
+    auto args = std::make_shared<std::pair<std::string, std::string>>(std::move(name), std::move(input));
+    submit([queue, id, args] {
+        auto& name = args->first;
+        auto& input = args->second;
+        char* out = nullptr;
+        int out_len = 0;
+        auto start = std::chrono::steady_clock::now();
+        auto err = wiltoncall(name.c_str(), static_cast<int> (name.length()),
+                input.c_str(), static_cast<int> (input.length()),
+                std::addressof(out), std::addressof(out_len));
+        auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(
+                std::chrono::steady_clock::now() - start);
+        auto completion = v8_async_completion();
+        completion.id = id;
+        completion.elapsed_us = static_cast<uint64_t>(elapsed.count());
+        if (nullptr == err) {
+            completion.output.reset(out);
+            completion.output_len = out_len;
+        } else {
+            completion.error = std::string(err);
+            wilton_free(err);
+        }
+        queue->post(std::move(completion));
+    });
+}
+
+v8_async_executor& v8_async_executor::shared(size_t threads_count) {
+    // threads count is taken from the first call made from v8_engine::initialize
+    static v8_async_executor executor(threads_count);
+    return executor;
+}
+
+bool v8_async_executor::is_worker_thread() {
+    return worker_thread;
+}
+
+void v8_async_executor::run_worker() {
+    worker_thread = true;
+    for (;;) {
+        auto task = std::function<void()>();
+        {
+            std::unique_lock<std::mutex> guard{mutex};
+            cv.wait(guard, [this] {
+                return stopping || !tasks.empty();
+            });
+            if (stopping) {
+                return;
+            }
+            task = std::move(tasks.front());
+            tasks.pop_front();
+        }
+        try {
+            task();
+        } catch (const std::exception& e) {
+            wilton::support::log_error("wilton.engine.v8.async", TRACEMSG(e.what() +
+                    "\nError running async task"));
+        } catch (...) {
+            wilton::support::log_error("wilton.engine.v8.async", TRACEMSG("Error(...) running async task"));
+        }
+    }
+}
+
+} // namespace
+}
@@ -0,0 +1,159 @@
+/*
+ * Copyright 2026, agent
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * File:   v8_async_executor.hpp
+ * Author: agent
+ */
+
+#ifndef WILTON_V8_ASYNC_EXECUTOR_HPP
+#define WILTON_V8_ASYNC_EXECUTOR_HPP
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "staticlib/config.hpp"
+
+#include "wilton/wilton.h"
+
+namespace wilton {
+namespace v8eng {
+
+class wilton_free_deleter {
+public:
+    void operator()(char* buf) const STATICLIB_NOEXCEPT {
+        wilton_free(buf);
+    }
+};
+
+/**
+ * Result of the wiltoncall performed on the worker thread
+ */
+class v8_async_completion {
+public:
+    uint64_t id = 0;
+    std::unique_ptr<char, wilton_free_deleter> output;
+    int output_len = 0;
+    std::string error;
+    // time spent in the wiltoncall itself, without queueing
+    uint64_t elapsed_us = 0;
+
+    v8_async_completion() { }
+
+    v8_async_completion(v8_async_completion&& other) :
+    id(other.id),
+    output(std::move(other.output)),
+    output_len(other.output_len),
+    error(std::move(other.error)),
+    elapsed_us(other.elapsed_us) { }
+
+    v8_async_completion& operator=(v8_async_completion&& other) {
+        this->id = other.id;
+        this->output = std::move(other.output);
+        this->output_len = other.output_len;
+        this->error = std::move(other.error);
+        this->elapsed_us = other.elapsed_us;
+        return *this;
+    }
+};
+
+/**
+ * Completions posted by workers to the owning engine
+ */
+class v8_completion_queue {
+    std::mutex mutex;
+    std::condition_variable cv;
+    std::deque<v8_async_completion> completions;
+    bool interrupted = false;
+
+public:
+    void post(v8_async_completion completion);
+
+    /**
+     * Takes completions, waiting for at least one of them if requested,
+     * wait returns early when the queue is interrupted
+     *
+     * @param wait whether to wait for completions
+     * @param deadline wait limit, 'time_point::max()' to wait without limit
+     * @return completions, may be empty after the deadline or interruption
+     */
+    std::vector<v8_async_completion> take_all(bool wait,
+            std::chrono::steady_clock::time_point deadline = std::chrono::steady_clock::time_point::max());
+
+    /**
+     * Wakes up the engine waiting for completions, called
+     * by the watchdog when callback execution is terminated
+     */
+    void interrupt();
+
+    bool is_interrupted();
+
+    void clear_interrupt();
+};
+
+/**
+ * Process-wide pool of native threads for async wiltoncalls,
+ * threads are started on first use
+ */
+class v8_async_executor {
+    std::mutex mutex;
+    std::condition_variable cv;
+    std::deque<std::function<void()>> tasks;
+    std::vector<std::thread> workers;
+    size_t threads_count;
+    bool stopping = false;
+
+public:
+    explicit v8_async_executor(size_t threads_count);
+
+    ~v8_async_executor() STATICLIB_NOEXCEPT;
+
+    v8_async_executor(const v8_async_executor&) = delete;
+
+    v8_async_executor& operator=(const v8_async_executor&) = delete;
+
+    void submit(std::function<void()> task);
+
+    void submit_wiltoncall(std::shared_ptr<v8_completion_queue> queue, uint64_t id,
+            std::string name, std::string input);
+
+    static v8_async_executor& shared(size_t threads_count = 0);
+
+    /**
+     * Checks whether the current thread is one of the executor workers,
+     * such threads must not wait for other executor tasks
+     *
+     * @return whether called from the worker thread
+     */
+    static bool is_worker_thread();
+
+private:
+    void run_worker();
+};
+
+} // namespace
+}
+
+#endif /* WILTON_V8_ASYNC_EXECUTOR_HPP */
+
@@ -0,0 +1,481 @@
+/*
+ * Copyright 2026, agent
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * File:   v8_channel.cpp
+ * Author: agent
+ */
+
+#include "v8_channel.hpp"
+
+#include <chrono>
+#include <cstring>
+#include <thread>
+
+#include "staticlib/support.hpp"
+
+#include "wilton/support/exception.hpp"
+
+#include "v8_allocator.hpp"
+
+namespace wilton {
+namespace v8eng {
+
+namespace { // anonymous
+
+const size_t spins_before_sleep = 64;
+
+void release_shared_backing(const v8::WeakCallbackInfo<v8_shared_backing_ref>& info) STATICLIB_NOEXCEPT {
+    v8_channel_registry::shared().remove_ref(info.GetParameter());
+}
+
+// isolate keeps the backing alive while its SharedArrayBuffer is reachable
+void attach_shared_backing(v8::Isolate* isolate, v8::Local<v8::SharedArrayBuffer> sab,
+        std::shared_ptr<v8_shared_backing> backing) {
+    auto ref = new v8_shared_backing_ref(isolate, std::move(backing));
+    ref->handle.Reset(isolate, sab);
+    ref->handle.SetWeak(ref, release_shared_backing, v8::WeakCallbackType::kParameter);
+    v8_channel_registry::shared().add_ref(ref);
+}
+
+std::shared_ptr<v8_shared_backing> acquire_shared_backing(v8::Isolate* isolate,
+        v8::Local<v8::SharedArrayBuffer> sab) {
+    auto& registry = v8_channel_registry::shared();
+    if (sab->IsExternal()) {
+        return registry.find_backing(sab->GetContents().Data());
+    }
+    auto contents = sab->Externalize();
+    auto backing = std::make_shared<v8_shared_backing>(contents.Data(), contents.ByteLength());
+    registry.add_backing(backing);
+    attach_shared_backing(isolate, sab, backing);
+    return backing;
+}
+
+class serializer_delegate : public v8::ValueSerializer::Delegate {
+    v8::Isolate* isolate;
+    v8_channel_message& message;
+
+public:
+    serializer_delegate(v8::Isolate* isolate, v8_channel_message& message) :
+    isolate(isolate),
+    message(message) { }
+
+    void ThrowDataCloneError(v8::Local<v8::String> msg) override {
+        isolate->ThrowException(msg);
+    }
+
+    v8::Maybe<uint32_t> GetSharedArrayBufferId(v8::Isolate*, v8::Local<v8::SharedArrayBuffer> sab) override {
+        auto backing = acquire_shared_backing(isolate, sab);
+        if (nullptr == backing.get()) {
+            auto msg = v8::String::NewFromUtf8(isolate, "SharedArrayBuffer externalized"
+                    " outside of channels cannot be shared", v8::NewStringType::kNormal);
+            if (!msg.IsEmpty()) {
+                isolate->ThrowException(msg.ToLocalChecked());
+            }
+            return v8::Nothing<uint32_t>();
+        }
+        for (size_t i = 0; i < message.shared.size(); i++) {
+            if (message.shared[i] == backing) {
+                return v8::Just(static_cast<uint32_t>(i));
+            }
+        }
+        message.shared.emplace_back(std::move(backing));
+        return v8::Just(static_cast<uint32_t>(message.shared.size() - 1));
+    }
+};
+
+class deserializer_delegate : public v8::ValueDeserializer::Delegate {
+    v8_channel_message& message;
+
+public:
+    deserializer_delegate(v8_channel_message& message) :
+    message(message) { }
+
+    v8::MaybeLocal<v8::SharedArrayBuffer> GetSharedArrayBufferFromId(v8::Isolate* isolate, uint32_t id) override {
+        if (id >= message.shared.size()) {
+            return v8::MaybeLocal<v8::SharedArrayBuffer>();
+        }
+        auto& backing = message.shared[id];
+        auto sab = v8::SharedArrayBuffer::New(isolate, backing->data, backing->length,
+                v8::ArrayBufferCreationMode::kExternalized);
+        attach_shared_backing(isolate, sab, backing);
+        return sab;
+    }
+};
+
+std::string extract_exception(v8::Isolate* isolate, v8::TryCatch& trycatch) {
+    if (!trycatch.HasCaught()) {
+        return std::string();
+    }
+    v8::String::Utf8Value utf8(isolate, trycatch.Exception());
+    if (utf8.length() > 0) {
+        return std::string(*utf8, static_cast<size_t>(utf8.length()));
+    }
+    return std::string();
+}
+
+} // namespace
+
+v8_shared_backing::v8_shared_backing(void* data, size_t length) :
+data(data),
+length(length) { }
+
+v8_shared_backing::~v8_shared_backing() STATICLIB_NOEXCEPT {
+    shared_array_buffer_allocator()->Free(data, length);
+}
+
+v8_channel_message::~v8_channel_message() STATICLIB_NOEXCEPT {
+    release_transferred();
+}
+
+v8_channel_message::v8_channel_message(v8_channel_message&& other) :
+data(std::move(other.data)),
+data_len(other.data_len),
+transferred(std::move(other.transferred)),
+shared(std::move(other.shared)) {
+    other.data_len = 0;
+    other.transferred.clear();
+}
+
+v8_channel_message& v8_channel_message::operator=(v8_channel_message&& other) {
+    release_transferred();
+    this->data = std::move(other.data);
+    this->data_len = other.data_len;
+    this->transferred = std::move(other.transferred);
+    this->shared = std::move(other.shared);
+    other.data_len = 0;
+    other.transferred.clear();
+    return *this;
+}
+
+void v8_channel_message::release_transferred() STATICLIB_NOEXCEPT {
+    for (auto& pa : transferred) {
+        if (nullptr != pa.first) {
+            shared_array_buffer_allocator()->Free(pa.first, pa.second);
+        }
+    }
+    transferred.clear();
+}
+
+v8_channel::v8_channel(size_t capacity) :
+enqueue_pos(0),
+dequeue_pos(0),
+closed(false) {
+    // rounded up to the power of two
+    size_t size = 2;
+    while (size < capacity) {
+        size <<= 1;
+    }
+    this->cells = std::unique_ptr<cell[]>(new cell[size]);
+    this->mask = size - 1;
+    for (size_t i = 0; i < size; i++) {
+        cells[i].sequence.store(i, std::memory_order_relaxed);
+    }
+}
+
+bool v8_channel::try_send(v8_channel_message& message) {
+    auto pos = enqueue_pos.load(std::memory_order_relaxed);
+    for (;;) {
+        auto& ce = cells[pos & mask];
+        auto seq = ce.sequence.load(std::memory_order_acquire);
+        auto diff = static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos);
+        if (0 == diff) {
+            if (enqueue_pos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                ce.message = std::move(message);
+                ce.sequence.store(pos + 1, std::memory_order_release);
+                return true;
+            }
+        } else if (diff < 0) {
+            return false;
+        } else {
+            pos = enqueue_pos.load(std::memory_order_relaxed);
+        }
+    }
+}
+
+bool v8_channel::try_receive(v8_channel_message& message) {
+    auto pos = dequeue_pos.load(std::memory_order_relaxed);
+    for (;;) {
+        auto& ce = cells[pos & mask];
+        auto seq = ce.sequence.load(std::memory_order_acquire);
+        auto diff = static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos + 1);
+        if (0 == diff) {
+            if (dequeue_pos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                message = std::move(ce.message);
+                ce.sequence.store(pos + mask + 1, std::memory_order_release);
+                return true;
+            }
+        } else if (diff < 0) {
+            return false;
+        } else {
+            pos = dequeue_pos.load(std::memory_order_relaxed);
+        }
+    }
+}
+
+bool v8_channel::send(v8_channel_message& message, int64_t timeout_ms) {
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeout_ms);
+    for (size_t attempt = 0; ; attempt++) {
+        if (is_closed()) {
+            return false;
+        }
+        if (try_send(message)) {
+            return true;
+        }
+        if (timeout_ms >= 0 && std::chrono::steady_clock::now() >= deadline) {
+            return false;
+        }
+        if (attempt < spins_before_sleep) {
+            std::this_thread::yield();
+        } else {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+    }
+}
+
+bool v8_channel::receive(v8_channel_message& message, int64_t timeout_ms) {
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeout_ms);
+    for (size_t attempt = 0; ; attempt++) {
+        if (try_receive(message)) {
+            return true;
+        }
+        if (is_closed()) {
+            // message may be sent right before closing
+            return try_receive(message);
+        }
+        if (timeout_ms >= 0 && std::chrono::steady_clock::now() >= deadline) {
+            return false;
+        }
+        if (attempt < spins_before_sleep) {
+            std::this_thread::yield();
+        } else {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+    }
+}
+
+void v8_channel::close() {
+    closed.store(true, std::memory_order_release);
+}
+
+bool v8_channel::is_closed() const {
+    return closed.load(std::memory_order_acquire);
+}
+
+size_t v8_channel::capacity() const {
+    return mask + 1;
+}
+
+std::shared_ptr<v8_channel> v8_channel_registry::create(const std::string& name, size_t capacity) {
+    std::lock_guard<std::mutex> guard{mutex};
+    auto it = channels.find(name);
+    if (channels.end() != it) {
+        return it->second;
+    }
+    auto channel = std::make_shared<v8_channel>(capacity);
+    channels.insert(std::make_pair(name, channel));
+    return channel;
+}
+
+std::shared_ptr<v8_channel> v8_channel_registry::find(const std::string& name) {
+    std::lock_guard<std::mutex> guard{mutex};
+    auto it = channels.find(name);
+    if (channels.end() == it) {
+        throw support::exception(TRACEMSG("Channel not found, name: [" + name + "]"));
+    }
+    return it->second;
+}
+
+bool v8_channel_registry::close(const std::string& name) {
+    auto channel = std::shared_ptr<v8_channel>();
+    {
+        std::lock_guard<std::mutex> guard{mutex};
+        auto it = channels.find(name);
+        if (channels.end() == it) {
+            return false;
+        }
+        channel = std::move(it->second);
+        channels.erase(it);
+    }
+    // messages left in the channel are freed with the last reference to it
+    channel->close();
+    return true;
+}
+
+std::shared_ptr<v8_shared_backing> v8_channel_registry::find_backing(void* data) {
+    std::lock_guard<std::mutex> guard{mutex};
+    auto it = backings.find(data);
+    if (backings.end() == it) {
+        return std::shared_ptr<v8_shared_backing>();
+    }
+    auto res = it->second.lock();
+    if (nullptr == res.get()) {
+        backings.erase(it);
+    }
+    return res;
+}
+
+void v8_channel_registry::add_backing(std::shared_ptr<v8_shared_backing> backing) {
+    std::lock_guard<std::mutex> guard{mutex};
+    // expired entry may exist for the reused address
+    backings[backing->data] = backing;
+}
+
+void v8_channel_registry::add_ref(v8_shared_backing_ref* ref) {
+    std::lock_guard<std::mutex> guard{mutex};
+    refs[ref->isolate].insert(ref);
+}
+
+void v8_channel_registry::remove_ref(v8_shared_backing_ref* ref) {
+    {
+        std::lock_guard<std::mutex> guard{mutex};
+        auto it = refs.find(ref->isolate);
+        if (refs.end() != it) {
+            it->second.erase(ref);
+            if (it->second.empty()) {
+                refs.erase(it);
+            }
+        }
+    }
+    release_ref(ref);
+}
+
+void v8_channel_registry::release_isolate(v8::Isolate* isolate) {
+    auto released = std::unordered_set<v8_shared_backing_ref*>();
+    {
+        std::lock_guard<std::mutex> guard{mutex};
+        auto it = refs.find(isolate);
+        if (refs.end() == it) {
+            return;
+        }
+        released = std::move(it->second);
+        refs.erase(it);
+    }
+    for (auto ref : released) {
+        release_ref(ref);
+    }
+}
+
+void v8_channel_registry::release_ref(v8_shared_backing_ref* ref) {
+    ref->handle.Reset();
+    auto data = ref->backing->data;
+    auto weak = std::weak_ptr<v8_shared_backing>(ref->backing);
+    // backing is freed outside of the lock when this was the last reference
+    delete ref;
+    if (weak.expired()) {
+        std::lock_guard<std::mutex> guard{mutex};
+        auto it = backings.find(data);
+        // address may be already reused by a new backing
+        if (backings.end() != it && it->second.expired()) {
+            backings.erase(it);
+        }
+    }
+}
+
+v8_channel_registry& v8_channel_registry::shared() {
+    static v8_channel_registry registry;
+    return registry;
+}
+
+v8_channel_message serialize_channel_message(v8::Local<v8::Context> ctx, v8::Local<v8::Value> value,
+        v8::Local<v8::Value> transfer_list) {
+    auto isolate = ctx->GetIsolate();
+    v8::HandleScope handle_scope(isolate);
+    auto message = v8_channel_message();
+    auto transfers = std::vector<v8::Local<v8::ArrayBuffer>>();
+    if (!transfer_list.IsEmpty() && transfer_list->IsArray()) {
+        auto arr = v8::Local<v8::Array>::Cast(transfer_list);
+        for (uint32_t i = 0; i < arr->Length(); i++) {
+            auto el_maybe = arr->Get(ctx, i);
+            if (el_maybe.IsEmpty() || !el_maybe.ToLocalChecked()->IsArrayBuffer()) {
+                throw support::exception(TRACEMSG("Invalid transfer list element, index: [" +
+                        sl::support::to_string(i) + "]"));
+            }
+            auto ab = v8::Local<v8::ArrayBuffer>::Cast(el_maybe.ToLocalChecked());
+            if (!ab->IsNeuterable()) {
+                throw support::exception(TRACEMSG("ArrayBuffer cannot be transferred, index: [" +
+                        sl::support::to_string(i) + "]"));
+            }
+            transfers.push_back(ab);
+        }
+    }
+    v8::TryCatch trycatch(isolate);
+    serializer_delegate delegate(isolate, message);
+    v8::ValueSerializer serializer(isolate, std::addressof(delegate));
+    serializer.WriteHeader();
+    for (size_t i = 0; i < transfers.size(); i++) {
+        serializer.TransferArrayBuffer(static_cast<uint32_t>(i), transfers[i]);
+    }
+    auto written = serializer.WriteValue(ctx, value);
+    if (written.IsNothing() || !written.FromJust()) {
+        throw support::exception(TRACEMSG("Error serializing channel message: [" +
+                extract_exception(isolate, trycatch) + "]"));
+    }
+    auto released = serializer.Release();
+    message.data.reset(released.first);
+    message.data_len = released.second;
+    // contents are taken from the sending isolate after successful serialization
+    auto allocator = shared_array_buffer_allocator();
+    for (auto& ab : transfers) {
+        if (ab->IsExternal()) {
+            // memory is owned by someone else, so it is copied
+            auto contents = ab->GetContents();
+            auto copy = allocator->AllocateUninitialized(contents.ByteLength());
+            if (nullptr == copy && contents.ByteLength() > 0) {
+                throw support::exception(TRACEMSG("Error allocating transferred ArrayBuffer," +
+                        " length: [" + sl::support::to_string(contents.ByteLength()) + "]"));
+            }
+            if (contents.ByteLength() > 0) {
+                std::memcpy(copy, contents.Data(), contents.ByteLength());
+            }
+            message.transferred.emplace_back(copy, contents.ByteLength());
+        } else {
+            auto contents = ab->Externalize();
+            message.transferred.emplace_back(contents.Data(), contents.ByteLength());
+        }
+        ab->Neuter();
+    }
+    return message;
+}
+
+v8::Local<v8::Value> deserialize_channel_message(v8::Local<v8::Context> ctx, v8_channel_message& message) {
+    auto isolate = ctx->GetIsolate();
+    v8::EscapableHandleScope handle_scope(isolate);
+    v8::TryCatch trycatch(isolate);
+    deserializer_delegate delegate(message);
+    v8::ValueDeserializer deserializer(isolate, message.data.get(), message.data_len, std::addressof(delegate));
+    auto header = deserializer.ReadHeader(ctx);
+    if (header.IsNothing() || !header.FromJust()) {
+        throw support::exception(TRACEMSG("Error reading channel message header: [" +
+                extract_exception(isolate, trycatch) + "]"));
+    }
+    for (size_t i = 0; i < message.transferred.size(); i++) {
+        auto& pa = message.transferred[i];
+        // ownership is passed to the receiving isolate
+        auto ab = v8::ArrayBuffer::New(isolate, pa.first, pa.second, v8::ArrayBufferCreationMode::kInternalized);
+        pa.first = nullptr;
+        deserializer.TransferArrayBuffer(static_cast<uint32_t>(i), ab);
+    }
+    auto value_maybe = deserializer.ReadValue(ctx);
+    if (value_maybe.IsEmpty()) {
+        throw support::exception(TRACEMSG("Error deserializing channel message: [" +
+                extract_exception(isolate, trycatch) + "]"));
+    }
+    return handle_scope.Escape(value_maybe.ToLocalChecked());
+}
+
+} // namespace
+}
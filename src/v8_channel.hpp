@@ -0,0 +1,219 @@
+/*
+ * Copyright 2026, agent
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * File:   v8_channel.hpp
+ * Author: agent
+ */
+
+#ifndef WILTON_V8_CHANNEL_HPP
+#define WILTON_V8_CHANNEL_HPP
+
+#include <atomic>
+#include <cstdint>
+#include <cstdlib>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+#include "v8.h"
+
+#include "staticlib/config.hpp"
+
+namespace wilton {
+namespace v8eng {
+
+/**
+ * Backing store of the SharedArrayBuffer that is used by multiple isolates,
+ * memory is released when the last isolate and the last message drop it
+ */
+class v8_shared_backing {
+public:
+    void* data;
+    size_t length;
+
+    v8_shared_backing(void* data, size_t length);
+
+    ~v8_shared_backing() STATICLIB_NOEXCEPT;
+
+    v8_shared_backing(const v8_shared_backing&) = delete;
+
+    v8_shared_backing& operator=(const v8_shared_backing&) = delete;
+};
+
+/**
+ * Reference from the isolate to the shared backing, kept while
+ * the SharedArrayBuffer is reachable in that isolate
+ */
+class v8_shared_backing_ref {
+public:
+    v8::Isolate* isolate;
+    v8::Global<v8::SharedArrayBuffer> handle;
+    std::shared_ptr<v8_shared_backing> backing;
+
+    v8_shared_backing_ref(v8::Isolate* isolate, std::shared_ptr<v8_shared_backing> backing) :
+    isolate(isolate),
+    backing(std::move(backing)) { }
+};
+
+class malloc_deleter {
+public:
+    void operator()(uint8_t* buf) const STATICLIB_NOEXCEPT {
+        std::free(buf);
+    }
+};
+
+/**
+ * Value serialized with v8::ValueSerializer together with
+ * transferred ArrayBuffer contents and shared backing stores
+ */
+class v8_channel_message {
+public:
+    std::unique_ptr<uint8_t, malloc_deleter> data;
+    size_t data_len = 0;
+    // owned until consumed by the receiving isolate
+    std::vector<std::pair<void*, size_t>> transferred;
+    std::vector<std::shared_ptr<v8_shared_backing>> shared;
+
+    v8_channel_message() { }
+
+    ~v8_channel_message() STATICLIB_NOEXCEPT;
+
+    v8_channel_message(v8_channel_message&& other);
+
+    v8_channel_message& operator=(v8_channel_message&& other);
+
+private:
+    void release_transferred() STATICLIB_NOEXCEPT;
+};
+
+/**
+ * Bounded lock-free MPMC queue of messages, blocking operations
+ * back off by yielding and sleeping, callers release the isolate
+ * lock while blocked
+ */
+class v8_channel {
+    class cell {
+    public:
+        std::atomic<size_t> sequence;
+        v8_channel_message message;
+    };
+
+    std::unique_ptr<cell[]> cells;
+    size_t mask;
+    alignas(64) std::atomic<size_t> enqueue_pos;
+    alignas(64) std::atomic<size_t> dequeue_pos;
+    std::atomic<bool> closed;
+
+public:
+    explicit v8_channel(size_t capacity);
+
+    v8_channel(const v8_channel&) = delete;
+
+    v8_channel& operator=(const v8_channel&) = delete;
+
+    bool try_send(v8_channel_message& message);
+
+    bool try_receive(v8_channel_message& message);
+
+    /**
+     * @return false on timeout or if the channel is closed
+     */
+    bool send(v8_channel_message& message, int64_t timeout_ms);
+
+    /**
+     * Messages sent before the channel was closed are still received
+     *
+     * @return false on timeout or if the channel is closed and empty
+     */
+    bool receive(v8_channel_message& message, int64_t timeout_ms);
+
+    /**
+     * Wakes up blocked senders and receivers, new messages are rejected
+     */
+    void close();
+
+    bool is_closed() const;
+
+    size_t capacity() const;
+};
+
+/**
+ * Process-wide named channels
+ */
+class v8_channel_registry {
+    std::mutex mutex;
+    std::unordered_map<std::string, std::shared_ptr<v8_channel>> channels;
+    std::unordered_map<void*, std::weak_ptr<v8_shared_backing>> backings;
+    std::unordered_map<v8::Isolate*, std::unordered_set<v8_shared_backing_ref*>> refs;
+
+public:
+    std::shared_ptr<v8_channel> create(const std::string& name, size_t capacity);
+
+    std::shared_ptr<v8_channel> find(const std::string& name);
+
+    /**
+     * Closes the channel and removes it from the registry,
+     * the name can be used to create a new channel
+     *
+     * @param name channel name
+     * @return whether the channel existed
+     */
+    bool close(const std::string& name);
+
+    std::shared_ptr<v8_shared_backing> find_backing(void* data);
+
+    void add_backing(std::shared_ptr<v8_shared_backing> backing);
+
+    void add_ref(v8_shared_backing_ref* ref);
+
+    /**
+     * Called from the weak callback when the SharedArrayBuffer is collected,
+     * deletes the reference and forgets the backing if it was the last one
+     *
+     * @param ref reference to release
+     */
+    void remove_ref(v8_shared_backing_ref* ref);
+
+    /**
+     * Drops references left in the isolate, weak callbacks
+     * are not run on disposal, so it must be called by the engine
+     * under the isolate lock before the isolate is disposed
+     *
+     * @param isolate isolate being disposed
+     */
+    void release_isolate(v8::Isolate* isolate);
+
+    static v8_channel_registry& shared();
+
+private:
+    void release_ref(v8_shared_backing_ref* ref);
+};
+
+v8_channel_message serialize_channel_message(v8::Local<v8::Context> ctx, v8::Local<v8::Value> value,
+        v8::Local<v8::Value> transfer_list);
+
+v8::Local<v8::Value> deserialize_channel_message(v8::Local<v8::Context> ctx, v8_channel_message& message);
+
+} // namespace
+}
+
+#endif /* WILTON_V8_CHANNEL_HPP */
+
@@ -0,0 +1,221 @@
+/*
+ * Copyright 2026, agent
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * File:   v8_code_cache.cpp
+ * Author: agent
+ */
+
+#include "v8_code_cache.hpp"
+
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+
+#ifdef _WIN32
+#include <process.h>
+#else // !_WIN32
+#include <unistd.h>
+#endif // _WIN32
+
+#include "v8.h"
+
+#include "staticlib/support.hpp"
+
+#include "wilton/support/logging.hpp"
+
+namespace wilton {
+namespace v8eng {
+
+namespace { // anonymous
+
+// ':' separated source hash and version tag
+const size_t key_suffix_length = 2 * (1 + 16);
+
+// FNV-1a, collisions are additionally guarded by V8 source hash check
+uint64_t hash_code(const char* code, size_t code_len) {
+    uint64_t hash = 14695981039346656037ULL;
+    for (size_t i = 0; i < code_len; i++) {
+        hash ^= static_cast<uint8_t>(code[i]);
+        hash *= 1099511628211ULL;
+    }
+    return hash;
+}
+
+std::string to_hex(uint64_t num) {
+    char buf[17];
+    std::snprintf(buf, sizeof(buf), "%016llx", static_cast<unsigned long long>(num));
+    return std::string(buf, 16);
+}
+
+std::string script_path_of(const std::string& key) {
+    return key.substr(0, key.length() - key_suffix_length);
+}
+
+int64_t process_id() {
+#ifdef _WIN32
+    return static_cast<int64_t>(::_getpid());
+#else // !_WIN32
+    return static_cast<int64_t>(::getpid());
+#endif // _WIN32
+}
+
+} // namespace
+
+v8_code_cache::v8_code_cache() :
+enabled(false),
+hits(0),
+misses(0),
+rejects(0),
+stale(0),
+tmp_files(0) { }
+
+void v8_code_cache::configure(bool enabled, const std::string& cache_dir) {
+    std::lock_guard<std::mutex> guard{mutex};
+    this->cache_dir = cache_dir;
+    this->enabled.store(enabled || !cache_dir.empty(), std::memory_order_release);
+}
+
+bool v8_code_cache::is_enabled() const {
+    return enabled.load(std::memory_order_acquire);
+}
+
+std::string v8_code_cache::make_key(const std::string& path, const char* code, size_t code_len) const {
+    auto version = static_cast<uint64_t>(v8::ScriptCompiler::CachedDataVersionTag());
+    return path + ":" + to_hex(hash_code(code, code_len)) + ":" + to_hex(version);
+}
+
+// only the index is accessed under the lock, disk I/O is done outside of it
+std::shared_ptr<std::string> v8_code_cache::find(const std::string& key) {
+    auto script_path = script_path_of(key);
+    auto dir = std::string();
+    {
+        std::lock_guard<std::mutex> guard{mutex};
+        auto it = entries.find(script_path);
+        if (entries.end() != it && key == it->second.key) {
+            hits += 1;
+            return it->second.data;
+        }
+        dir = cache_dir;
+    }
+    if (!dir.empty()) {
+        std::ifstream stream{file_path(dir, script_path), std::ios::binary};
+        if (stream.is_open()) {
+            // file starts with the key line, entry for older source
+            // or V8 version is replaced by the following 'put'
+            auto file_key = std::string();
+            std::getline(stream, file_key);
+            if (key != file_key) {
+                stale += 1;
+            } else {
+                auto data = std::make_shared<std::string>(std::istreambuf_iterator<char>(stream),
+                        std::istreambuf_iterator<char>());
+                if (!stream.bad() && data->length() > 0) {
+                    hits += 1;
+                    std::lock_guard<std::mutex> guard{mutex};
+                    auto& en = entries[script_path];
+                    // entry put by other thread meanwhile is preferred
+                    if (key != en.key) {
+                        en.key = key;
+                        en.data = data;
+                    }
+                    return en.data;
+                }
+            }
+        }
+    }
+    misses += 1;
+    return std::shared_ptr<std::string>();
+}
+
+void v8_code_cache::put(const std::string& key, const char* data, size_t data_len) {
+    auto script_path = script_path_of(key);
+    auto data_ptr = std::make_shared<std::string>(data, data_len);
+    auto dir = std::string();
+    {
+        std::lock_guard<std::mutex> guard{mutex};
+        auto& en = entries[script_path];
+        en.key = key;
+        en.data = data_ptr;
+        dir = cache_dir;
+    }
+    if (dir.empty()) {
+        return;
+    }
+    auto path = file_path(dir, script_path);
+    // concurrent writers of the same entry in this and other processes use own files
+    auto tmp_path = path + "." + sl::support::to_string(process_id()) + "." +
+            sl::support::to_string(tmp_files.fetch_add(1, std::memory_order_relaxed)) + ".tmp";
+    {
+        std::ofstream stream{tmp_path, std::ios::binary | std::ios::trunc};
+        stream << key << '\n';
+        stream.write(data_ptr->data(), static_cast<std::streamsize>(data_ptr->length()));
+        if (!stream.good()) {
+            wilton::support::log_warn("wilton.engine.v8.codecache",
+                    "Error writing code cache file, path: [" + tmp_path + "]");
+            stream.close();
+            std::remove(tmp_path.c_str());
+            return;
+        }
+    }
+    // readers in other processes never see partial files,
+    // file of the previous entry for this script is replaced
+    if (0 != std::rename(tmp_path.c_str(), path.c_str())) {
+        std::remove(tmp_path.c_str());
+    }
+}
+
+void v8_code_cache::reject(const std::string& key) {
+    rejects += 1;
+    auto script_path = script_path_of(key);
+    auto dir = std::string();
+    {
+        std::lock_guard<std::mutex> guard{mutex};
+        auto it = entries.find(script_path);
+        if (entries.end() != it && key == it->second.key) {
+            entries.erase(it);
+        }
+        dir = cache_dir;
+    }
+    if (!dir.empty()) {
+        std::remove(file_path(dir, script_path).c_str());
+    }
+    wilton::support::log_debug("wilton.engine.v8.codecache",
+            "Code cache entry rejected, key: [" + key + "]");
+}
+
+sl::json::value v8_code_cache::stats() const {
+    return {
+        { "enabled", is_enabled() },
+        { "hits", static_cast<int64_t>(hits.load()) },
+        { "misses", static_cast<int64_t>(misses.load()) },
+        { "rejects", static_cast<int64_t>(rejects.load()) },
+        { "stale", static_cast<int64_t>(stale.load()) }
+    };
+}
+
+v8_code_cache& v8_code_cache::shared() {
+    static v8_code_cache cache;
+    return cache;
+}
+
+std::string v8_code_cache::file_path(const std::string& dir, const std::string& script_path) const {
+    // one file per script, path is hashed to get a flat file name
+    return dir + "/" + to_hex(hash_code(script_path.data(), script_path.length())) + ".v8cache";
+}
+
+} // namespace
+}
@@ -0,0 +1,93 @@
+/*
+ * Copyright 2026, agent
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * File:   v8_code_cache.hpp
+ * Author: agent
+ */
+
+#ifndef WILTON_V8_CODE_CACHE_HPP
+#define WILTON_V8_CODE_CACHE_HPP
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+#include "staticlib/json.hpp"
+
+namespace wilton {
+namespace v8eng {
+
+/**
+ * Process-wide storage for V8 code cache entries, shared by all isolates.
+ * Entries are keyed by script path and content hash, and optionally
+ * persisted to a directory on disk. Only the latest entry is kept
+ * for each script path, both in memory and on disk.
+ */
+class v8_code_cache {
+    class entry {
+    public:
+        std::string key;
+        std::shared_ptr<std::string> data;
+    };
+
+    std::mutex mutex;
+    // keyed by script path
+    std::unordered_map<std::string, entry> entries;
+    std::atomic<bool> enabled;
+    std::string cache_dir;
+
+    std::atomic<uint64_t> hits;
+    std::atomic<uint64_t> misses;
+    std::atomic<uint64_t> rejects;
+    std::atomic<uint64_t> stale;
+    std::atomic<uint64_t> tmp_files;
+
+public:
+    v8_code_cache();
+
+    v8_code_cache(const v8_code_cache&) = delete;
+
+    v8_code_cache& operator=(const v8_code_cache&) = delete;
+
+    void configure(bool enabled, const std::string& cache_dir);
+
+    bool is_enabled() const;
+
+    std::string make_key(const std::string& path, const char* code, size_t code_len) const;
+
+    std::shared_ptr<std::string> find(const std::string& key);
+
+    void put(const std::string& key, const char* data, size_t data_len);
+
+    void reject(const std::string& key);
+
+    sl::json::value stats() const;
+
+    static v8_code_cache& shared();
+
+private:
+    std::string file_path(const std::string& dir, const std::string& script_path) const;
+};
+
+} // namespace
+}
+
+#endif /* WILTON_V8_CODE_CACHE_HPP */
+
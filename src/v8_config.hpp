@@ -25,11 +25,17 @@
 #define WILTON_V8_CONFIG_HPP
 
 #include <cstdint>
+#include <memory>
+#include <string>
 
 #include "staticlib/json.hpp"
 #include "staticlib/support.hpp"
 #include "staticlib/utils.hpp"
 
+#include "wilton/wilton.h"
+
+#include "wilton/support/exception.hpp"
+
 namespace wilton {
 namespace v8eng {
 
@@ -40,6 +46,34 @@ public:
     uint16_t max_old_space_size = 0;
     uint16_t code_range_size = 0;
     uint16_t max_zone_pool_size = 0;
+    bool startup_snapshot = false;
+    std::string snapshot_modules;
+    bool code_cache = false;
+    std::string code_cache_dir;
+    uint16_t gc_idle_budget_max_ms = 0;
+    uint32_t gc_rss_threshold_mb = 0;
+    uint32_t gc_heap_threshold_mb = 0;
+    uint16_t gc_heap_limit_extra_mb = 0;
+    uint16_t isolate_pool_size = 0;
+    uint32_t isolate_pool_lease_timeout_ms = 0;
+    uint16_t async_pool_size = 4;
+    bool callback_payload_objects = false;
+    uint32_t array_buffer_budget_mb = 0;
+    uint32_t array_buffer_pool_mb = 64;
+    uint32_t streaming_min_size_kb = 0;
+    std::string preload_manifest;
+    bool platform_affinity = false;
+    uint32_t cpu_profile_interval_us = 1000;
+    std::string cpu_profile_dir = ".";
+    std::string heap_profile_dir = ".";
+    uint32_t callback_timeout_ms = 0;
+    bool callback_timeout_cpu = false;
+    uint16_t watchdog_tick_ms = 10;
+    bool shared_sources = false;
+    uint16_t spare_engines = 0;
+    uint32_t recycle_calls = 0;
+    uint32_t recycle_old_space_mb = 0;
+    uint32_t recycle_age_s = 0;
 
     v8_config(const sl::json::value& env_json) {
         for (const sl::json::field& fi : env_json.as_object()) {
@@ -55,6 +89,62 @@ public:
                     this->code_range_size = str_as_u16(fi, name);
                 } else if ("V8_zone_pool_size" == name) {
                     this->max_old_space_size = str_as_u16(fi, name);
+                } else if ("V8_startup_snapshot" == name) {
+                    this->startup_snapshot = str_as_bool(fi, name);
+                } else if ("V8_snapshot_modules" == name) {
+                    this->snapshot_modules = fi.as_string_nonempty_or_throw(name);
+                } else if ("V8_code_cache" == name) {
+                    this->code_cache = str_as_bool(fi, name);
+                } else if ("V8_code_cache_dir" == name) {
+                    this->code_cache_dir = fi.as_string_nonempty_or_throw(name);
+                } else if ("V8_gc_idle_budget_max_ms" == name) {
+                    this->gc_idle_budget_max_ms = str_as_u16(fi, name);
+                } else if ("V8_gc_rss_threshold_mb" == name) {
+                    this->gc_rss_threshold_mb = str_as_u32(fi, name);
+                } else if ("V8_gc_heap_threshold_mb" == name) {
+                    this->gc_heap_threshold_mb = str_as_u32(fi, name);
+                } else if ("V8_gc_heap_limit_extra_mb" == name) {
+                    this->gc_heap_limit_extra_mb = str_as_u16(fi, name);
+                } else if ("V8_isolate_pool_size" == name) {
+                    this->isolate_pool_size = str_as_u16(fi, name);
+                } else if ("V8_isolate_pool_lease_timeout_ms" == name) {
+                    this->isolate_pool_lease_timeout_ms = str_as_u32(fi, name);
+                } else if ("V8_async_pool_size" == name) {
+                    this->async_pool_size = str_as_u16(fi, name);
+                } else if ("V8_callback_payload_objects" == name) {
+                    this->callback_payload_objects = str_as_bool(fi, name);
+                } else if ("V8_array_buffer_budget_mb" == name) {
+                    this->array_buffer_budget_mb = str_as_u32(fi, name);
+                } else if ("V8_array_buffer_pool_mb" == name) {
+                    this->array_buffer_pool_mb = str_as_u32(fi, name);
+                } else if ("V8_streaming_min_size_kb" == name) {
+                    this->streaming_min_size_kb = str_as_u32(fi, name);
+                } else if ("V8_preload_manifest" == name) {
+                    this->preload_manifest = fi.as_string_nonempty_or_throw(name);
+                } else if ("V8_platform_affinity" == name) {
+                    this->platform_affinity = str_as_bool(fi, name);
+                } else if ("V8_cpu_profile_interval_us" == name) {
+                    this->cpu_profile_interval_us = str_as_u32(fi, name);
+                } else if ("V8_cpu_profile_dir" == name) {
+                    this->cpu_profile_dir = fi.as_string_nonempty_or_throw(name);
+                } else if ("V8_heap_profile_dir" == name) {
+                    this->heap_profile_dir = fi.as_string_nonempty_or_throw(name);
+                } else if ("V8_callback_timeout_ms" == name) {
+                    this->callback_timeout_ms = str_as_u32(fi, name);
+                } else if ("V8_callback_timeout_cpu" == name) {
+                    this->callback_timeout_cpu = str_as_bool(fi, name);
+                } else if ("V8_watchdog_tick_ms" == name) {
+                    this->watchdog_tick_ms = str_as_u16(fi, name);
+                } else if ("V8_shared_sources" == name) {
+                    this->shared_sources = str_as_bool(fi, name);
+                } else if ("V8_spare_engines" == name) {
+                    this->spare_engines = str_as_u16(fi, name);
+                } else if ("V8_recycle_calls" == name) {
+                    this->recycle_calls = str_as_u32(fi, name);
+                } else if ("V8_recycle_old_space_mb" == name) {
+                    this->recycle_old_space_mb = str_as_u32(fi, name);
+                } else if ("V8_recycle_age_s" == name) {
+                    this->recycle_age_s = str_as_u32(fi, name);
                 } else {
                     throw support::exception(TRACEMSG("Unknown 'v8_config' field: [" + name + "]"));
                 }
@@ -67,7 +157,35 @@ public:
     max_semi_space_size_in_kb(other.max_semi_space_size_in_kb),
     max_old_space_size(other.max_old_space_size),
     code_range_size(other.code_range_size),
-    max_zone_pool_size(other.max_zone_pool_size) { }
+    max_zone_pool_size(other.max_zone_pool_size),
+    startup_snapshot(other.startup_snapshot),
+    snapshot_modules(other.snapshot_modules),
+    code_cache(other.code_cache),
+    code_cache_dir(other.code_cache_dir),
+    gc_idle_budget_max_ms(other.gc_idle_budget_max_ms),
+    gc_rss_threshold_mb(other.gc_rss_threshold_mb),
+    gc_heap_threshold_mb(other.gc_heap_threshold_mb),
+    gc_heap_limit_extra_mb(other.gc_heap_limit_extra_mb),
+    isolate_pool_size(other.isolate_pool_size),
+    isolate_pool_lease_timeout_ms(other.isolate_pool_lease_timeout_ms),
+    async_pool_size(other.async_pool_size),
+    callback_payload_objects(other.callback_payload_objects),
+    array_buffer_budget_mb(other.array_buffer_budget_mb),
+    array_buffer_pool_mb(other.array_buffer_pool_mb),
+    streaming_min_size_kb(other.streaming_min_size_kb),
+    preload_manifest(other.preload_manifest),
+    platform_affinity(other.platform_affinity),
+    cpu_profile_interval_us(other.cpu_profile_interval_us),
+    cpu_profile_dir(other.cpu_profile_dir),
+    heap_profile_dir(other.heap_profile_dir),
+    callback_timeout_ms(other.callback_timeout_ms),
+    callback_timeout_cpu(other.callback_timeout_cpu),
+    watchdog_tick_ms(other.watchdog_tick_ms),
+    shared_sources(other.shared_sources),
+    spare_engines(other.spare_engines),
+    recycle_calls(other.recycle_calls),
+    recycle_old_space_mb(other.recycle_old_space_mb),
+    recycle_age_s(other.recycle_age_s) { }
 
     v8_config& operator=(const v8_config&  other) {
         this->thread_pool_size = other.thread_pool_size;
@@ -75,6 +193,34 @@ public:
         this->max_old_space_size = other.max_old_space_size;
         this->code_range_size = other.code_range_size;
         this->max_zone_pool_size = other.max_zone_pool_size;
+        this->startup_snapshot = other.startup_snapshot;
+        this->snapshot_modules = other.snapshot_modules;
+        this->code_cache = other.code_cache;
+        this->code_cache_dir = other.code_cache_dir;
+        this->gc_idle_budget_max_ms = other.gc_idle_budget_max_ms;
+        this->gc_rss_threshold_mb = other.gc_rss_threshold_mb;
+        this->gc_heap_threshold_mb = other.gc_heap_threshold_mb;
+        this->gc_heap_limit_extra_mb = other.gc_heap_limit_extra_mb;
+        this->isolate_pool_size = other.isolate_pool_size;
+        this->isolate_pool_lease_timeout_ms = other.isolate_pool_lease_timeout_ms;
+        this->async_pool_size = other.async_pool_size;
+        this->callback_payload_objects = other.callback_payload_objects;
+        this->array_buffer_budget_mb = other.array_buffer_budget_mb;
+        this->array_buffer_pool_mb = other.array_buffer_pool_mb;
+        this->streaming_min_size_kb = other.streaming_min_size_kb;
+        this->preload_manifest = other.preload_manifest;
+        this->platform_affinity = other.platform_affinity;
+        this->cpu_profile_interval_us = other.cpu_profile_interval_us;
+        this->cpu_profile_dir = other.cpu_profile_dir;
+        this->heap_profile_dir = other.heap_profile_dir;
+        this->callback_timeout_ms = other.callback_timeout_ms;
+        this->callback_timeout_cpu = other.callback_timeout_cpu;
+        this->watchdog_tick_ms = other.watchdog_tick_ms;
+        this->shared_sources = other.shared_sources;
+        this->spare_engines = other.spare_engines;
+        this->recycle_calls = other.recycle_calls;
+        this->recycle_old_space_mb = other.recycle_old_space_mb;
+        this->recycle_age_s = other.recycle_age_s;
         return *this;
     }
 
@@ -84,10 +230,54 @@ public:
             { "max_semi_space_size_in_kb", max_semi_space_size_in_kb },
             { "max_old_space_size", max_old_space_size },
             { "code_range_size", code_range_size },
-            { "max_zone_pool_size", max_zone_pool_size }
+            { "max_zone_pool_size", max_zone_pool_size },
+            { "startup_snapshot", startup_snapshot },
+            { "snapshot_modules", snapshot_modules },
+            { "code_cache", code_cache },
+            { "code_cache_dir", code_cache_dir },
+            { "gc_idle_budget_max_ms", gc_idle_budget_max_ms },
+            { "gc_rss_threshold_mb", gc_rss_threshold_mb },
+            { "gc_heap_threshold_mb", gc_heap_threshold_mb },
+            { "gc_heap_limit_extra_mb", gc_heap_limit_extra_mb },
+            { "isolate_pool_size", isolate_pool_size },
+            { "isolate_pool_lease_timeout_ms", isolate_pool_lease_timeout_ms },
+            { "async_pool_size", async_pool_size },
+            { "callback_payload_objects", callback_payload_objects },
+            { "array_buffer_budget_mb", array_buffer_budget_mb },
+            { "array_buffer_pool_mb", array_buffer_pool_mb },
+            { "streaming_min_size_kb", streaming_min_size_kb },
+            { "preload_manifest", preload_manifest },
+            { "platform_affinity", platform_affinity },
+            { "cpu_profile_interval_us", cpu_profile_interval_us },
+            { "cpu_profile_dir", cpu_profile_dir },
+            { "heap_profile_dir", heap_profile_dir },
+            { "callback_timeout_ms", callback_timeout_ms },
+            { "callback_timeout_cpu", callback_timeout_cpu },
+            { "watchdog_tick_ms", watchdog_tick_ms },
+            { "shared_sources", shared_sources },
+            { "spare_engines", spare_engines },
+            { "recycle_calls", recycle_calls },
+            { "recycle_old_space_mb", recycle_old_space_mb },
+            { "recycle_age_s", recycle_age_s }
         };
     }
 
+    bool recycling_enabled() const {
+        return recycle_calls > 0 || recycle_old_space_mb > 0 || recycle_age_s > 0;
+    }
+
+    static v8_config from_wilton_config() {
+        char* conf = nullptr;
+        int conf_len = 0;
+        auto err = wilton_config(std::addressof(conf), std::addressof(conf_len));
+        if (nullptr != err) support::throw_wilton_error(err, TRACEMSG(err));
+        auto deferred = sl::support::defer([conf] () STATICLIB_NOEXCEPT {
+            wilton_free(conf);
+        });
+        auto json = sl::json::load({const_cast<const char*>(conf), conf_len});
+        return v8_config(json["environmentVariables"]);
+    }
+
 private:
     static uint16_t str_as_u16(const sl::json::field& fi, const std::string& name) {
         auto str = fi.as_string_nonempty_or_throw(name);
@@ -99,6 +289,17 @@ private:
         }
     }
 
+    static bool str_as_bool(const sl::json::field& fi, const std::string& name) {
+        auto str = fi.as_string_nonempty_or_throw(name);
+        if ("true" == str) {
+            return true;
+        } else if ("false" == str) {
+            return false;
+        }
+        throw support::exception(TRACEMSG("Error parsing boolean parameter: [" + name + "]," +
+                " value: [" + str + "]"));
+    }
+
     static uint32_t str_as_u32(const sl::json::field& fi, const std::string& name) {
         auto str = fi.as_string_nonempty_or_throw(name);
         try {
@@ -0,0 +1,407 @@
+/*
+ * Copyright 2026, agent
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * File:   v8_cpu_profiler.cpp
+ * Author: agent
+ */
+
+#include "v8_cpu_profiler.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <thread>
+
+#include "staticlib/support.hpp"
+
+#include "wilton/support/exception.hpp"
+#include "wilton/support/logging.hpp"
+
+namespace wilton {
+namespace v8eng {
+
+namespace { // anonymous
+
+const size_t written_max_count = 64;
+
+sl::json::value json_u64(uint64_t num) {
+    return sl::json::value(static_cast<int64_t>(num));
+}
+
+v8::Local<v8::String> profile_title(v8::Isolate* isolate, uint64_t engine_id) {
+    auto title = "wilton-" + sl::support::to_string(engine_id);
+    return v8::String::NewFromUtf8(isolate, title.c_str(), v8::NewStringType::kNormal,
+            static_cast<int>(title.length())).ToLocalChecked();
+}
+
+// Chrome DevTools '.cpuprofile' format, line and column numbers are zero-based
+sl::json::value profile_to_json(const v8::CpuProfile* profile) {
+    auto nodes = std::vector<sl::json::value>();
+    // iterative walk, call trees of deep recursions do not overflow the stack
+    auto stack = std::vector<const v8::CpuProfileNode*>();
+    stack.push_back(profile->GetTopDownRoot());
+    while (!stack.empty()) {
+        auto node = stack.back();
+        stack.pop_back();
+        auto children = std::vector<sl::json::value>();
+        for (int i = 0; i < node->GetChildrenCount(); i++) {
+            auto child = node->GetChild(i);
+            children.emplace_back(json_u64(child->GetNodeId()));
+            stack.push_back(child);
+        }
+        auto line = node->GetLineNumber();
+        auto column = node->GetColumnNumber();
+        nodes.emplace_back(sl::json::value({
+            { "id", json_u64(node->GetNodeId()) },
+            { "callFrame", {
+                { "functionName", std::string(node->GetFunctionNameStr()) },
+                { "scriptId", sl::support::to_string(node->GetScriptId()) },
+                { "url", std::string(node->GetScriptResourceNameStr()) },
+                { "lineNumber", static_cast<int64_t>(line > 0 ? line - 1 : -1) },
+                { "columnNumber", static_cast<int64_t>(column > 0 ? column - 1 : -1) }
+            }},
+            { "hitCount", json_u64(node->GetHitCount()) },
+            { "children", std::move(children) }
+        }));
+    }
+    auto samples = std::vector<sl::json::value>();
+    auto deltas = std::vector<sl::json::value>();
+    auto last_ts = profile->GetStartTime();
+    for (int i = 0; i < profile->GetSamplesCount(); i++) {
+        samples.emplace_back(json_u64(profile->GetSample(i)->GetNodeId()));
+        auto ts = profile->GetSampleTimestamp(i);
+        deltas.emplace_back(static_cast<int64_t>(ts - last_ts));
+        last_ts = ts;
+    }
+    return {
+        { "nodes", std::move(nodes) },
+        { "startTime", static_cast<int64_t>(profile->GetStartTime()) },
+        { "endTime", static_cast<int64_t>(profile->GetEndTime()) },
+        { "samples", std::move(samples) },
+        { "timeDeltas", std::move(deltas) }
+    };
+}
+
+void write_file(const std::string& path, const std::string& data) {
+    auto tmp_path = path + ".tmp";
+    {
+        std::ofstream stream{tmp_path, std::ios::binary | std::ios::trunc};
+        if (!stream.is_open()) {
+            throw support::exception(TRACEMSG("Error opening profile file, path: [" + tmp_path + "]"));
+        }
+        stream.write(data.data(), static_cast<std::streamsize>(data.length()));
+        if (!stream.good()) {
+            throw support::exception(TRACEMSG("Error writing profile file, path: [" + tmp_path + "]"));
+        }
+    }
+    if (0 != std::rename(tmp_path.c_str(), path.c_str())) {
+        std::remove(tmp_path.c_str());
+        throw support::exception(TRACEMSG("Error renaming profile file, path: [" + path + "]"));
+    }
+}
+
+} // namespace
+
+v8_cpu_profiler::v8_cpu_profiler(v8::Isolate* isolate, uint64_t engine_id) :
+isolate(isolate),
+engine_id(engine_id),
+requests_pending(false),
+running(false) { }
+
+uint64_t v8_cpu_profiler::id() const {
+    return engine_id;
+}
+
+std::string v8_cpu_profiler::thread_id() const {
+    std::lock_guard<std::mutex> guard{mutex};
+    return last_thread;
+}
+
+bool v8_cpu_profiler::is_running() const {
+    return running.load(std::memory_order_relaxed);
+}
+
+void v8_cpu_profiler::request_start(int interval_us, const std::string& dir) {
+    std::lock_guard<std::mutex> guard{mutex};
+    start_requested = true;
+    stop_requested = false;
+    requested_interval_us = interval_us;
+    requested_dir = dir;
+    requests_pending.store(true, std::memory_order_release);
+}
+
+void v8_cpu_profiler::request_stop() {
+    std::lock_guard<std::mutex> guard{mutex};
+    start_requested = false;
+    stop_requested = true;
+    requests_pending.store(true, std::memory_order_release);
+}
+
+void v8_cpu_profiler::apply_requests() STATICLIB_NOEXCEPT {
+    // thread changes only when pooled engine is leased to another thread
+    bool thread_changed = std::this_thread::get_id() != applied_thread;
+    if (!thread_changed && !requests_pending.load(std::memory_order_acquire)) {
+        return;
+    }
+    bool start_req = false;
+    bool stop_req = false;
+    int interval_us = 0;
+    auto dir = std::string();
+    try {
+        if (thread_changed) {
+            auto tid = v8_cpu_profiler_registry::current_thread_id();
+            std::lock_guard<std::mutex> guard{mutex};
+            last_thread = std::move(tid);
+            this->applied_thread = std::this_thread::get_id();
+        }
+        {
+            std::lock_guard<std::mutex> guard{mutex};
+            requests_pending.store(false, std::memory_order_relaxed);
+            if (!start_requested && !stop_requested) {
+                return;
+            }
+            start_req = start_requested;
+            stop_req = stop_requested;
+            interval_us = requested_interval_us;
+            dir = requested_dir;
+            start_requested = false;
+            stop_requested = false;
+        }
+        if (stop_req && nullptr != profiler) {
+            stop_and_write();
+        }
+        if (start_req && nullptr == profiler) {
+            start(interval_us, dir);
+        }
+    } catch (const std::exception& e) {
+        wilton::support::log_error("wilton.engine.v8.profiler", TRACEMSG(e.what() +
+                "\nError applying CPU profiler request, engine: [" + sl::support::to_string(engine_id) + "]"));
+    }
+}
+
+void v8_cpu_profiler::close() STATICLIB_NOEXCEPT {
+    if (nullptr == profiler) {
+        return;
+    }
+    v8::HandleScope handle_scope(isolate);
+    auto profile = profiler->StopProfiling(profile_title(isolate, engine_id));
+    if (nullptr != profile) {
+        profile->Delete();
+    }
+    profiler->Dispose();
+    profiler = nullptr;
+    running.store(false, std::memory_order_relaxed);
+}
+
+void v8_cpu_profiler::start(int interval_us, const std::string& dir) {
+    v8::HandleScope handle_scope(isolate);
+    this->profiler = v8::CpuProfiler::New(isolate);
+    // must be set before the start
+    profiler->SetSamplingInterval(interval_us);
+    profiler->StartProfiling(profile_title(isolate, engine_id), true);
+    this->profile_dir = dir;
+    running.store(true, std::memory_order_relaxed);
+    wilton::support::log_info("wilton.engine.v8.profiler", std::string() + "CPU profiling started," +
+            " engine: [" + sl::support::to_string(engine_id) + "]," +
+            " interval (us): [" + sl::support::to_string(interval_us) + "]");
+}
+
+void v8_cpu_profiler::stop_and_write() {
+    v8::HandleScope handle_scope(isolate);
+    auto profile = profiler->StopProfiling(profile_title(isolate, engine_id));
+    // sampler is not needed anymore, profiler is created again on next start
+    auto deferred = sl::support::defer([this, profile] () STATICLIB_NOEXCEPT {
+        if (nullptr != profile) {
+            profile->Delete();
+        }
+        profiler->Dispose();
+        profiler = nullptr;
+        running.store(false, std::memory_order_relaxed);
+    });
+    if (nullptr == profile) {
+        return;
+    }
+    auto millis = std::chrono::duration_cast<std::chrono::milliseconds>(
+            std::chrono::system_clock::now().time_since_epoch()).count();
+    auto path = profile_dir + "/v8-" + sl::support::to_string(engine_id) + "-" +
+            sl::support::to_string(millis) + ".cpuprofile";
+    auto samples = profile->GetSamplesCount();
+    auto json = profile_to_json(profile);
+    write_file(path, json.dumps());
+    wilton::support::log_info("wilton.engine.v8.profiler", std::string() + "CPU profile written," +
+            " engine: [" + sl::support::to_string(engine_id) + "]," +
+            " samples: [" + sl::support::to_string(samples) + "]," +
+            " path: [" + path + "]");
+    v8_cpu_profiler_registry::shared().add_written({
+        { "engine", json_u64(engine_id) },
+        { "path", path },
+        { "samples", static_cast<int64_t>(samples) }
+    });
+}
+
+v8_cpu_profiler_registry::v8_cpu_profiler_registry() :
+next_id(1) { }
+
+void v8_cpu_profiler_registry::configure(int default_interval_us, const std::string& default_dir) {
+    std::lock_guard<std::mutex> guard{mutex};
+    this->default_interval_us = default_interval_us;
+    this->default_dir = default_dir;
+}
+
+uint64_t v8_cpu_profiler_registry::next_engine_id() {
+    return next_id.fetch_add(1, std::memory_order_relaxed);
+}
+
+void v8_cpu_profiler_registry::add(std::shared_ptr<v8_cpu_profiler> profiler) {
+    std::lock_guard<std::mutex> guard{mutex};
+    live.emplace_back(std::move(profiler));
+}
+
+void v8_cpu_profiler_registry::remove(const std::shared_ptr<v8_cpu_profiler>& profiler) {
+    std::lock_guard<std::mutex> guard{mutex};
+    auto it = std::find(live.begin(), live.end(), profiler);
+    if (live.end() != it) {
+        live.erase(it);
+    }
+}
+
+sl::json::value v8_cpu_profiler_registry::start(const sl::json::value& options) {
+    auto interval_us = 0;
+    auto dir = std::string();
+    {
+        std::lock_guard<std::mutex> guard{mutex};
+        interval_us = default_interval_us;
+        dir = default_dir;
+    }
+    auto& interval_json = options["samplingIntervalUs"];
+    if (sl::json::type::nullt != interval_json.json_type()) {
+        interval_us = static_cast<int>(interval_json.as_uint32_or_throw("samplingIntervalUs"));
+    }
+    auto& dir_json = options["directory"];
+    if (sl::json::type::nullt != dir_json.json_type()) {
+        dir = dir_json.as_string_nonempty_or_throw("directory");
+    }
+    if (interval_us <= 0) {
+        throw support::exception(TRACEMSG("Invalid sampling interval specified: [" +
+                sl::support::to_string(interval_us) + "]"));
+    }
+    auto ids = std::vector<sl::json::value>();
+    for (auto& pr : select(options)) {
+        pr->request_start(interval_us, dir);
+        ids.emplace_back(json_u64(pr->id()));
+    }
+    return {
+        { "engines", std::move(ids) },
+        { "samplingIntervalUs", interval_us },
+        { "directory", dir }
+    };
+}
+
+sl::json::value v8_cpu_profiler_registry::stop(const sl::json::value& options) {
+    auto ids = std::vector<sl::json::value>();
+    for (auto& pr : select(options)) {
+        pr->request_stop();
+        ids.emplace_back(json_u64(pr->id()));
+    }
+    return {
+        { "engines", std::move(ids) }
+    };
+}
+
+sl::json::value v8_cpu_profiler_registry::status() {
+    std::lock_guard<std::mutex> guard{mutex};
+    auto engines = std::vector<sl::json::value>();
+    for (auto& pr : live) {
+        engines.emplace_back(sl::json::value({
+            { "engine", json_u64(pr->id()) },
+            { "thread", pr->thread_id() },
+            { "running", pr->is_running() }
+        }));
+    }
+    auto profiles = std::vector<sl::json::value>();
+    for (auto& wr : written) {
+        profiles.emplace_back(wr.clone());
+    }
+    return {
+        { "engines", std::move(engines) },
+        { "profiles", std::move(profiles) }
+    };
+}
+
+void v8_cpu_profiler_registry::add_written(sl::json::value profile_info) {
+    std::lock_guard<std::mutex> guard{mutex};
+    written.emplace_back(std::move(profile_info));
+    if (written.size() > written_max_count) {
+        written.pop_front();
+    }
+}
+
+std::vector<uint64_t> v8_cpu_profiler_registry::select_ids(const sl::json::value& options) {
+    auto res = std::vector<uint64_t>();
+    for (auto& pr : select(options)) {
+        res.push_back(pr->id());
+    }
+    return res;
+}
+
+std::string v8_cpu_profiler_registry::current_thread_id() {
+    // formatted once per thread
+    static thread_local std::string tid = [] {
+        std::ostringstream stream;
+        stream << std::this_thread::get_id();
+        return stream.str();
+    }();
+    return tid;
+}
+
+v8_cpu_profiler_registry& v8_cpu_profiler_registry::shared() {
+    static v8_cpu_profiler_registry registry;
+    return registry;
+}
+
+std::vector<std::shared_ptr<v8_cpu_profiler>> v8_cpu_profiler_registry::select(const sl::json::value& options) {
+    auto engine = std::string();
+    auto& engine_json = options["engine"];
+    if (sl::json::type::nullt != engine_json.json_type()) {
+        engine = sl::support::to_string(engine_json.as_int64_or_throw("engine"));
+    }
+    auto thread = std::string();
+    auto& thread_json = options["thread"];
+    if (sl::json::type::nullt != thread_json.json_type()) {
+        thread = thread_json.as_string_nonempty_or_throw("thread");
+        if ("current" == thread) {
+            thread = current_thread_id();
+        }
+    }
+    std::lock_guard<std::mutex> guard{mutex};
+    auto res = std::vector<std::shared_ptr<v8_cpu_profiler>>();
+    for (auto& pr : live) {
+        if (!engine.empty() && engine != sl::support::to_string(pr->id())) {
+            continue;
+        }
+        if (!thread.empty() && thread != pr->thread_id()) {
+            continue;
+        }
+        res.push_back(pr);
+    }
+    return res;
+}
+
+} // namespace
+}
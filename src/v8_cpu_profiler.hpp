@@ -0,0 +1,155 @@
+/*
+ * Copyright 2026, agent
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * File:   v8_cpu_profiler.hpp
+ * Author: agent
+ */
+
+#ifndef WILTON_V8_CPU_PROFILER_HPP
+#define WILTON_V8_CPU_PROFILER_HPP
+
+#include <atomic>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "v8.h"
+#include "v8-profiler.h"
+
+#include "staticlib/config.hpp"
+#include "staticlib/json.hpp"
+
+namespace wilton {
+namespace v8eng {
+
+/**
+ * Per-engine CPU profiling state. Sampler must be started on the thread
+ * that runs JS, so start and stop requests made from other threads
+ * are applied by the engine around its next callback.
+ */
+class v8_cpu_profiler {
+    v8::Isolate* isolate;
+    uint64_t engine_id;
+
+    // guards requests and the thread id
+    mutable std::mutex mutex;
+    bool start_requested = false;
+    bool stop_requested = false;
+    int requested_interval_us = 0;
+    std::string requested_dir;
+    std::string last_thread;
+    // checked before taking the mutex on every callback
+    std::atomic<bool> requests_pending;
+
+    // accessed only with the isolate locked
+    std::thread::id applied_thread;
+    v8::CpuProfiler* profiler = nullptr;
+    std::string profile_dir;
+    std::atomic<bool> running;
+
+public:
+    v8_cpu_profiler(v8::Isolate* isolate, uint64_t engine_id);
+
+    v8_cpu_profiler(const v8_cpu_profiler&) = delete;
+
+    v8_cpu_profiler& operator=(const v8_cpu_profiler&) = delete;
+
+    uint64_t id() const;
+
+    std::string thread_id() const;
+
+    bool is_running() const;
+
+    void request_start(int interval_us, const std::string& dir);
+
+    void request_stop();
+
+    /**
+     * Applies pending requests, must be called with the isolate locked
+     * on the thread that runs callbacks, does not lock or allocate
+     * when there are no requests and the thread is not changed
+     */
+    void apply_requests() STATICLIB_NOEXCEPT;
+
+    /**
+     * Discards running profile, must be called with the isolate
+     * locked before the isolate is disposed
+     */
+    void close() STATICLIB_NOEXCEPT;
+
+private:
+    void start(int interval_us, const std::string& dir);
+
+    void stop_and_write();
+};
+
+/**
+ * Process-wide registry of engine profilers used by the control wiltoncalls
+ */
+class v8_cpu_profiler_registry {
+    std::mutex mutex;
+    std::vector<std::shared_ptr<v8_cpu_profiler>> live;
+    std::deque<sl::json::value> written;
+    std::atomic<uint64_t> next_id;
+    int default_interval_us = 1000;
+    std::string default_dir = ".";
+
+public:
+    v8_cpu_profiler_registry();
+
+    void configure(int default_interval_us, const std::string& default_dir);
+
+    uint64_t next_engine_id();
+
+    void add(std::shared_ptr<v8_cpu_profiler> profiler);
+
+    void remove(const std::shared_ptr<v8_cpu_profiler>& profiler);
+
+    /**
+     * Requests profiling start on the selected engines
+     *
+     * @param options JSON with optional "engine" id, "thread" id (or "current"),
+     *        "samplingIntervalUs" and "directory" fields
+     * @return ids of the selected engines
+     */
+    sl::json::value start(const sl::json::value& options);
+
+    sl::json::value stop(const sl::json::value& options);
+
+    sl::json::value status();
+
+    void add_written(sl::json::value profile_info);
+
+    std::vector<uint64_t> select_ids(const sl::json::value& options);
+
+    static std::string current_thread_id();
+
+    static v8_cpu_profiler_registry& shared();
+
+private:
+    std::vector<std::shared_ptr<v8_cpu_profiler>> select(const sl::json::value& options);
+};
+
+} // namespace
+}
+
+#endif /* WILTON_V8_CPU_PROFILER_HPP */
+
@@ -23,12 +23,19 @@
 
 #include "v8_engine.hpp"
 
+#include <algorithm>
+#include <atomic>
+#include <chrono>
 #include <cstdio>
+#include <cstring>
 #include <functional>
+#include <limits>
 #include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
 
 #include "v8.h"
-#include "libplatform/libplatform.h"
 
 #include "staticlib/io.hpp"
 #include "staticlib/json.hpp"
@@ -39,27 +46,40 @@
 #include "wilton/wilton.h"
 #include "wilton/wiltoncall.h"
 #include "wilton/wilton_loader.h"
+#include "wilton/wilton_logging.h"
 
 #include "wilton/support/exception.hpp"
 #include "wilton/support/logging.hpp"
 
+#include "v8_allocator.hpp"
+#include "v8_async_executor.hpp"
+#include "v8_channel.hpp"
+#include "v8_code_cache.hpp"
 #include "v8_config.hpp"
+#include "v8_cpu_profiler.hpp"
+#include "v8_gc_scheduler.hpp"
+#include "v8_heap_profiler.hpp"
+#include "v8_metrics.hpp"
+#include "v8_module_preloader.hpp"
+#include "v8_platform.hpp"
+#include "v8_source_store.hpp"
+#include "v8_script_streamer.hpp"
+#include "v8_watchdog.hpp"
 
 namespace wilton {
 namespace v8eng {
 
 namespace { // anonymous
 
-v8_config get_config() {
-    char* conf = nullptr;
-    int conf_len = 0;
-    auto err = wilton_config(std::addressof(conf), std::addressof(conf_len));
-    if (nullptr != err) support::throw_wilton_error(err, TRACEMSG(err));
-    auto deferred = sl::support::defer([conf] () STATICLIB_NOEXCEPT {
-        wilton_free(conf);
-    });
-    auto json = sl::json::load({const_cast<const char*>(conf), conf_len});
-    return v8_config(json["environmentVariables"]);
+// initialized from v8_engine::initialize
+v8_platform* platform = nullptr;
+
+// set while the startup snapshot is created, snapshot isolate
+// has no per-isolate data and cannot hold external strings
+std::atomic<v8::Isolate*> snapshot_isolate{nullptr};
+
+bool is_snapshot_isolate(v8::Isolate* isolate) {
+    return isolate == snapshot_isolate.load(std::memory_order_acquire);
 }
 
 void set_constraints(v8::ResourceConstraints& constraints, v8_config& cfg) {
@@ -77,6 +97,58 @@ void set_constraints(v8::ResourceConstraints& constraints, v8_config& cfg) {
     }
 }
 
+bool is_debug_enabled(const std::string& logger) STATICLIB_NOEXCEPT {
+    // allows to skip building log messages on hot paths
+    int res = 0;
+    auto err = wilton_logger_is_level_enabled(logger.c_str(), static_cast<int>(logger.length()),
+            "DEBUG", 5, std::addressof(res));
+    if (nullptr != err) {
+        wilton_free(err);
+        return false;
+    }
+    return 0 != res;
+}
+
+const std::chrono::seconds debug_level_refresh{1};
+
+/**
+ * Cached result of 'is_debug_enabled', the check goes through the logging
+ * API, so it is repeated only periodically to pick up level changes
+ */
+class debug_level {
+    std::string logger;
+    std::atomic<bool> enabled;
+    std::atomic<int64_t> checked_at_ms;
+
+public:
+    explicit debug_level(std::string logger) :
+    logger(std::move(logger)),
+    enabled(false),
+    checked_at_ms(std::numeric_limits<int64_t>::min()) { }
+
+    debug_level(const debug_level&) = delete;
+
+    debug_level& operator=(const debug_level&) = delete;
+
+    const std::string& name() const {
+        return logger;
+    }
+
+    bool is_enabled() STATICLIB_NOEXCEPT {
+        auto now = std::chrono::duration_cast<std::chrono::milliseconds>(
+                std::chrono::steady_clock::now().time_since_epoch()).count();
+        auto checked = checked_at_ms.load(std::memory_order_relaxed);
+        if (checked > std::numeric_limits<int64_t>::min() &&
+                now - checked < std::chrono::milliseconds(debug_level_refresh).count()) {
+            return enabled.load(std::memory_order_relaxed);
+        }
+        bool res = is_debug_enabled(logger);
+        enabled.store(res, std::memory_order_relaxed);
+        checked_at_ms.store(now, std::memory_order_relaxed);
+        return res;
+    }
+};
+
 v8::Local<v8::String> string_to_jsval(v8::Isolate* isolate, const char* str, size_t str_len) STATICLIB_NOEXCEPT {
     v8::EscapableHandleScope handle_scope(isolate);
     auto maybe = v8::String::NewFromUtf8(isolate, str, v8::NewStringType::kNormal, static_cast<int>(str_len));
@@ -92,21 +164,47 @@ v8::Local<v8::String> string_to_jsval(v8::Isolate* isolate, const std::string& s
     return string_to_jsval(isolate, str.data(), str.length());
 }
 
-void throw_js_exception(v8::Local<v8::Context>& ctx, const std::string& msg) {
-    // v8::Exception::Error segfaults for some reason
+// property names used by the native calls
+enum class property_key {
+    name, input, binary_output, result, error, message, stack, count
+};
+
+const char* property_key_names[] = {
+    "name", "input", "binaryOutput", "result", "error", "message", "stack"
+};
+
+// interned names are cached per isolate in 'call_cache' defined below
+v8::Local<v8::String> key_to_jsval(v8::Isolate* isolate, property_key id);
+
+// instance of the per-isolate native error constructor defined below,
+// empty if it is not available
+v8::MaybeLocal<v8::Object> new_native_error(v8::Local<v8::Context> ctx);
+
+v8::Local<v8::Value> create_js_error(v8::Local<v8::Context>& ctx, const std::string& msg) {
+    // v8::Exception::Error takes Error constructor from the entered
+    // context and crashes without one, so context is entered explicitly
     auto isolate = ctx->GetIsolate();
-    v8::HandleScope handle_scope(isolate);
-    auto json = sl::json::value({
-        {"message", msg},
-        {"stack", ""}
-    });
-    auto json_val = string_to_jsval(isolate, json.dumps());
-    auto err_maybe = v8::JSON::Parse(ctx, json_val);
+    v8::EscapableHandleScope handle_scope(isolate);
+    v8::Context::Scope ctx_scope(ctx);
+    auto msg_val = string_to_jsval(isolate, msg);
+    // captures the stack, it is formatted only when read
+    auto captured = v8::Exception::Error(msg_val);
+    auto err_maybe = new_native_error(ctx);
     if (err_maybe.IsEmpty()) {
-        auto str = string_to_jsval(isolate, msg);
-        isolate->ThrowException(str);
+        return handle_scope.Escape(captured);
     }
+    // errors inherit from Error, but have own enumerable 'message' and
+    // lazy 'stack', so they serialize as the '{message, stack}' objects used before
     auto err = err_maybe.ToLocalChecked();
+    err->Set(ctx, key_to_jsval(isolate, property_key::message), msg_val).FromMaybe(false);
+    err->SetInternalField(0, captured);
+    return handle_scope.Escape(err);
+}
+
+void throw_js_exception(v8::Local<v8::Context>& ctx, const std::string& msg) {
+    auto isolate = ctx->GetIsolate();
+    v8::HandleScope handle_scope(isolate);
+    auto err = create_js_error(ctx, msg);
     isolate->ThrowException(err);
 }
 
@@ -118,6 +216,48 @@ std::string jsval_to_string(v8::Isolate* isolate, const v8::Local<v8::Value>& va
     return std::string();
 }
 
+// UTF-8 is written directly into the wilton-allocated buffer
+support::buffer jsval_to_buffer(v8::Local<v8::String> str) {
+    auto len = str->Utf8Length();
+    auto buf = wilton_alloc(len + 1);
+    if (nullptr == buf) {
+        throw support::exception(TRACEMSG("Error allocating result buffer, length: [" +
+                sl::support::to_string(len) + "]"));
+    }
+    auto written = str->WriteUtf8(buf, len, nullptr, v8::String::NO_NULL_TERMINATION);
+    buf[written] = '\0';
+    return support::wrap_wilton_buffer(buf, written);
+}
+
+bool contains(sl::io::span<const char> line, const char* needle) {
+    auto begin = line.data();
+    auto end = line.data() + line.size();
+    return end != std::search(begin, end, needle, needle + std::strlen(needle));
+}
+
+std::string filter_stack_trace(const std::string& stack) {
+    // lines are filtered in place without splitting the stack into a vector
+    auto res = std::string();
+    res.reserve(stack.length());
+    size_t begin = 0;
+    while (begin < stack.length()) {
+        auto end = stack.find('\n', begin);
+        if (std::string::npos == end) {
+            end = stack.length();
+        }
+        auto line = sl::io::span<const char>(stack.data() + begin, end - begin);
+        if (line.size() > 1 && !contains(line, "wilton-requirejs/require.js:") &&
+                !contains(line, "wilton-require.js:")) {
+            if (!res.empty()) {
+                res.push_back('\n');
+            }
+            res.append(line.data(), line.size());
+        }
+        begin = end + 1;
+    }
+    return res;
+}
+
 std::string format_stack_trace(v8::Local<v8::Context>& ctx, const v8::TryCatch& trycatch) STATICLIB_NOEXCEPT {
     auto isolate = ctx->GetIsolate();
     v8::HandleScope handle_scope(isolate);
@@ -127,48 +267,116 @@ std::string format_stack_trace(v8::Local<v8::Context>& ctx, const v8::TryCatch&
         auto stack_val = stack_maybe.ToLocalChecked();
         stack = jsval_to_string(isolate, stack_val);
     }
-    auto vec = sl::utils::split(stack, '\n');
-    auto res = std::string();
-    for (size_t i = 0; i < vec.size(); i++) {
-        auto& line = vec.at(i);
-        if (line.length() > 1 && !(std::string::npos != line.find("wilton-requirejs/require.js:")) &&
-                !(std::string::npos != line.find("wilton-require.js:"))) {
-            res += line;
-            res.push_back('\n');
-        }
-    }
-    if (res.length() > 0 && '\n' == res.back()) {
-        res.pop_back();
+    return filter_stack_trace(stack);
+}
+
+v8::MaybeLocal<v8::Script> compile_script(v8::Local<v8::Context>& ctx, v8::Local<v8::String> code_val,
+        v8::ScriptOrigin& origin, std::shared_ptr<std::string> cached_data, bool& cache_rejected) {
+    if (nullptr == cached_data.get()) {
+        v8::ScriptCompiler::Source source(code_val, origin);
+        return v8::ScriptCompiler::Compile(ctx, std::addressof(source));
     }
+    // data is kept alive by the shared_ptr until compilation is complete
+    auto cached = new v8::ScriptCompiler::CachedData(reinterpret_cast<const uint8_t*>(cached_data->data()),
+            static_cast<int>(cached_data->length()), v8::ScriptCompiler::CachedData::BufferNotOwned);
+    // source takes ownership of the cached data object
+    v8::ScriptCompiler::Source source(code_val, origin, cached);
+    auto res = v8::ScriptCompiler::Compile(ctx, std::addressof(source),
+            v8::ScriptCompiler::kConsumeCodeCache);
+    cache_rejected = source.GetCachedData()->rejected;
     return res;
 }
 
-std::string eval_js(v8::Local<v8::Context>& ctx, const char* code, size_t code_len, const std::string& path) {
+void store_code_cache(v8::Local<v8::Script> script, const std::string& cache_key) {
+    auto data = std::unique_ptr<v8::ScriptCompiler::CachedData>(
+            v8::ScriptCompiler::CreateCodeCache(script->GetUnboundScript()));
+    if (nullptr != data.get() && data->length > 0) {
+        auto& cache = v8_code_cache::shared();
+        cache.put(cache_key, reinterpret_cast<const char*>(data->data), static_cast<size_t>(data->length));
+    }
+}
+
+// code_val must contain the same source as code or be empty to be created from code
+std::string eval_js(v8::Local<v8::Context>& ctx, const char* code, size_t code_len,
+        v8::Local<v8::String> code_val, const std::string& path, bool use_code_cache) {
     auto isolate = ctx->GetIsolate();
     v8::HandleScope handle_scope(isolate);
     v8::Context::Scope ctx_scope(ctx);
     // compile
-    auto code_val = string_to_jsval(isolate, code, code_len);
     auto path_val = string_to_jsval(isolate, path);
     v8::ScriptOrigin origin(path_val);
-    v8::ScriptCompiler::Source source(code_val, origin);
     v8::TryCatch trycatch(isolate);
-    auto script_maybe = v8::ScriptCompiler::Compile(ctx, std::addressof(source));
+    auto& cache = v8_code_cache::shared();
+    auto cache_key = std::string();
+    auto cached_data = std::shared_ptr<std::string>();
+    if (use_code_cache && cache.is_enabled()) {
+        cache_key = cache.make_key(path, code, code_len);
+        cached_data = cache.find(cache_key);
+    }
+    auto metrics = v8_metrics::of_isolate(isolate);
+    auto make_code_val = [isolate, code, code_len, code_val] {
+        return code_val.IsEmpty() ? string_to_jsval(isolate, code, code_len) : code_val;
+    };
+    auto& streamer = v8_script_streamer::shared();
+    auto compile_start = std::chrono::steady_clock::now();
+    bool cache_rejected = false;
+    auto script_maybe = v8::MaybeLocal<v8::Script>();
+    // only module loads are streamed, cached code is cheaper
+    // to deserialize than to parse in background
+    if (use_code_cache && nullptr == cached_data.get() && streamer.is_enabled_for(code_len)) {
+        auto times = v8_streaming_times();
+        script_maybe = streamer.compile(ctx, code, code_len, make_code_val, origin, times);
+        if (nullptr != metrics) {
+            metrics->eval_compile.record_since(compile_start);
+            metrics->eval_stream.record(static_cast<uint64_t>(times.parse.count()));
+            metrics->stream_bytes.fetch_add(static_cast<uint64_t>(code_len), std::memory_order_relaxed);
+            if (times.parse > times.wait) {
+                metrics->stream_offloaded_us.fetch_add(static_cast<uint64_t>((times.parse - times.wait).count()),
+                        std::memory_order_relaxed);
+            }
+        }
+    } else {
+        auto source_val = make_code_val();
+        compile_start = std::chrono::steady_clock::now();
+        script_maybe = compile_script(ctx, source_val, origin, cached_data, cache_rejected);
+        if (nullptr != metrics) {
+            metrics->eval_compile.record_since(compile_start);
+        }
+    }
+    if (cache_rejected) {
+        cache.reject(cache_key);
+    }
     if (script_maybe.IsEmpty()) {
         auto stack = format_stack_trace(ctx, trycatch);
         throw support::exception(TRACEMSG(stack));
     }
     auto script = script_maybe.ToLocalChecked();
     // run
+    auto run_start = std::chrono::steady_clock::now();
     auto run_maybe = script->Run(ctx);
+    if (nullptr != metrics) {
+        metrics->eval_run.record_since(run_start);
+    }
     if (run_maybe.IsEmpty()) {
         auto stack = format_stack_trace(ctx, trycatch);
         throw support::exception(TRACEMSG(stack));
     }
+    // cache is created after the run to include lazily compiled functions
+    if (!cache_key.empty() && (nullptr == cached_data.get() || cache_rejected)) {
+        store_code_cache(script, cache_key);
+    }
     auto run = run_maybe.ToLocalChecked();
     return jsval_to_string(isolate, run);
 }
 
+std::string eval_js(v8::Local<v8::Context>& ctx, const char* code, size_t code_len, const std::string& path,
+        bool use_code_cache = false) {
+    auto isolate = ctx->GetIsolate();
+    v8::HandleScope handle_scope(isolate);
+    auto code_val = string_to_jsval(isolate, code, code_len);
+    return eval_js(ctx, code, code_len, code_val, path, use_code_cache);
+}
+
 void print_func(const v8::FunctionCallbackInfo<v8::Value>& args) STATICLIB_NOEXCEPT {
     auto isolate = args.GetIsolate();
     if (args.Length() > 0) {
@@ -179,6 +387,26 @@ void print_func(const v8::FunctionCallbackInfo<v8::Value>& args) STATICLIB_NOEXC
     }
 }
 
+void eval_module(v8::Local<v8::Context>& ctx, const std::string& path, const char* code, size_t code_len,
+        v8::Local<v8::String> code_val) {
+    auto metrics = v8_metrics::of_isolate(ctx->GetIsolate());
+    if (nullptr != metrics) {
+        metrics->load_count.fetch_add(1, std::memory_order_relaxed);
+        metrics->load_bytes.fetch_add(static_cast<uint64_t>(code_len), std::memory_order_relaxed);
+    }
+    auto path_short = support::script_engine_map_detail::shorten_script_path(path);
+    static debug_level logger("wilton.engine.v8.eval");
+    bool debug = logger.is_enabled();
+    if (debug) {
+        wilton::support::log_debug("wilton.engine.v8.eval",
+                "Evaluating source file, path: [" + path + "] ...");
+    }
+    eval_js(ctx, code, code_len, code_val, path_short, true);
+    if (debug) {
+        wilton::support::log_debug("wilton.engine.v8.eval", "Eval complete");
+    }
+}
+
 void load_func(const v8::FunctionCallbackInfo<v8::Value>& args) STATICLIB_NOEXCEPT {
     auto isolate = args.GetIsolate();
     v8::HandleScope handle_scope(isolate);
@@ -190,22 +418,35 @@ void load_func(const v8::FunctionCallbackInfo<v8::Value>& args) STATICLIB_NOEXCE
             throw support::exception(TRACEMSG("Invalid arguments specified"));
         }
         path = jsval_to_string(isolate, args[0]);
-        // load code
+        // load code, modules from preload manifest are already in memory
+        auto preloaded = v8_module_preloader::shared().find(path);
+        // shared sources are loaded once per process and are not copied into isolate heap,
+        // external strings cannot be serialized, so snapshot creator uses the copying path
+        auto& sources = v8_source_store::shared();
+        if (sources.is_enabled() && !is_snapshot_isolate(isolate)) {
+            auto source = sources.load(path, preloaded);
+            eval_module(ctx, path, source->data(), source->length(), sources.to_jsval(isolate, source));
+            return;
+        }
         char* code = nullptr;
         int code_len = 0;
-        auto err_load = wilton_load_resource(path.c_str(), static_cast<int>(path.length()),
-                std::addressof(code), std::addressof(code_len));
-        if (nullptr != err_load) {
-            support::throw_wilton_error(err_load, TRACEMSG(err_load));
+        if (nullptr != preloaded.get()) {
+            code = const_cast<char*>(preloaded->data());
+            code_len = static_cast<int>(preloaded->length());
+        } else {
+            auto err_load = wilton_load_resource(path.c_str(), static_cast<int>(path.length()),
+                    std::addressof(code), std::addressof(code_len));
+            if (nullptr != err_load) {
+                support::throw_wilton_error(err_load, TRACEMSG(err_load));
+            }
         }
-        auto deferred = sl::support::defer([code] () STATICLIB_NOEXCEPT {
-            wilton_free(code);
+        auto deferred = sl::support::defer([code, preloaded] () STATICLIB_NOEXCEPT {
+            if (nullptr == preloaded.get()) {
+                wilton_free(code);
+            }
         });
-        auto path_short = support::script_engine_map_detail::shorten_script_path(path);
-        wilton::support::log_debug("wilton.engine.v8.eval",
-                "Evaluating source file, path: [" + path + "] ...");
-        eval_js(ctx, code, static_cast<size_t>(code_len), path_short);
-        wilton::support::log_debug("wilton.engine.v8.eval", "Eval complete");
+        // source string is created by eval, streamed compilation overlaps it with the parse
+        eval_module(ctx, path, code, static_cast<size_t>(code_len), v8::Local<v8::String>());
     } catch (const std::exception& e) {
         auto msg = TRACEMSG(e.what() + "\nError loading script, path: [" + path + "]");
         throw_js_exception(ctx, msg);
@@ -215,35 +456,197 @@ void load_func(const v8::FunctionCallbackInfo<v8::Value>& args) STATICLIB_NOEXCE
     }
 }
 
-void wiltoncall_func(const v8::FunctionCallbackInfo<v8::Value>& args) STATICLIB_NOEXCEPT {
+bool is_binary_jsval(const v8::Local<v8::Value>& value) {
+    return value->IsArrayBuffer() || value->IsArrayBufferView();
+}
+
+sl::io::span<const char> binary_jsval_to_span(const v8::Local<v8::Value>& value) {
+    // contents are not copied, backing store is not moved by GC
+    auto contents = v8::ArrayBuffer::Contents();
+    size_t offset = 0;
+    size_t len = 0;
+    if (value->IsArrayBufferView()) {
+        auto view = v8::Local<v8::ArrayBufferView>::Cast(value);
+        contents = view->Buffer()->GetContents();
+        offset = view->ByteOffset();
+        len = view->ByteLength();
+    } else {
+        contents = v8::Local<v8::ArrayBuffer>::Cast(value)->GetContents();
+        len = contents.ByteLength();
+    }
+    if (nullptr == contents.Data()) {
+        return sl::io::span<const char>("", 0);
+    }
+    return sl::io::span<const char>(static_cast<const char*>(contents.Data()) + offset, len);
+}
+
+const uint32_t external_buffers_isolate_slot = 3;
+
+class external_buffer_list;
+
+class external_buffer {
+public:
+    v8::Global<v8::ArrayBuffer> handle;
+    char* data;
+    int data_len;
+    // intrusive links, list is accessed only under the isolate lock
+    external_buffer_list* list = nullptr;
+    external_buffer* prev = nullptr;
+    external_buffer* next = nullptr;
+
+    external_buffer(char* data, int data_len) :
+    data(data),
+    data_len(data_len) { }
+
+    ~external_buffer() STATICLIB_NOEXCEPT {
+        wilton_free(data);
+    }
+};
+
+/**
+ * Buffers passed to JS by the engine, weak callbacks are not run
+ * on isolate disposal, so buffers still alive are freed by the engine
+ */
+class external_buffer_list {
+    external_buffer* head = nullptr;
+
+public:
+    static external_buffer_list* of_isolate(v8::Isolate* isolate) {
+        return static_cast<external_buffer_list*>(isolate->GetData(external_buffers_isolate_slot));
+    }
+
+    void link(external_buffer* buf) {
+        buf->list = this;
+        buf->next = head;
+        if (nullptr != head) {
+            head->prev = buf;
+        }
+        head = buf;
+    }
+
+    void unlink(external_buffer* buf) {
+        if (nullptr != buf->prev) {
+            buf->prev->next = buf->next;
+        } else {
+            head = buf->next;
+        }
+        if (nullptr != buf->next) {
+            buf->next->prev = buf->prev;
+        }
+        buf->list = nullptr;
+        buf->prev = nullptr;
+        buf->next = nullptr;
+    }
+
+    // must be called before the isolate is disposed
+    void free_all() {
+        while (nullptr != head) {
+            auto buf = head;
+            unlink(buf);
+            buf->handle.Reset();
+            delete buf;
+        }
+    }
+};
+
+void free_external_buffer(const v8::WeakCallbackInfo<external_buffer>& info) STATICLIB_NOEXCEPT {
+    auto buf = info.GetParameter();
+    if (nullptr != buf->list) {
+        buf->list->unlink(buf);
+    }
+    buf->handle.Reset();
+    info.GetIsolate()->AdjustAmountOfExternalAllocatedMemory(-static_cast<int64_t>(buf->data_len));
+    delete buf;
+}
+
+// takes ownership of the wilton-allocated buffer, it is freed
+// with 'wilton_free' when array buffer is garbage collected
+v8::Local<v8::ArrayBuffer> wilton_buffer_to_jsval(v8::Isolate* isolate, char* data, int data_len) {
+    v8::EscapableHandleScope handle_scope(isolate);
+    auto buf = new external_buffer(data, data_len);
+    auto ab = v8::ArrayBuffer::New(isolate, data, static_cast<size_t>(data_len),
+            v8::ArrayBufferCreationMode::kExternalized);
+    buf->handle.Reset(isolate, ab);
+    buf->handle.SetWeak(buf, free_external_buffer, v8::WeakCallbackType::kParameter);
+    auto list = external_buffer_list::of_isolate(isolate);
+    if (nullptr != list) {
+        list->link(buf);
+    }
+    isolate->AdjustAmountOfExternalAllocatedMemory(static_cast<int64_t>(data_len));
+    return handle_scope.Escape(ab);
+}
+
+const uint32_t call_cache_isolate_slot = 2;
+
+// names come from scripts, calls beyond the limit are resolved on every call
+const size_t call_sites_max_count = 1024;
+
+// everything that does not depend on call arguments is resolved once per name
+class native_binding {
+public:
+    std::string name;
+    debug_level debug;
+    latency_histogram* hist;
+
+    native_binding(const std::string& name, latency_histogram* hist) :
+    name(name),
+    debug("wilton.wiltoncall." + name),
+    hist(hist) { }
+};
+
+// input is taken from args[input_idx], optional boolean
+// at args[input_idx + 1] selects binary output
+void perform_wiltoncall(const v8::FunctionCallbackInfo<v8::Value>& args, int input_idx,
+        native_binding& binding) {
     auto isolate = args.GetIsolate();
-    v8::HandleScope handle_scope(isolate);
     auto ctx = isolate->GetCurrentContext();
-    v8::Context::Scope ctx_scope(ctx);
-    if (args.Length() < 2 || !args[0]->IsString() || !args[1]->IsString()) {
-        auto msg = TRACEMSG("Invalid arguments specified");
-        throw_js_exception(ctx, msg);
-        return;
+    // binary input is passed without copying, result is returned
+    // as ArrayBuffer by default if input is binary
+    auto input_str = std::string();
+    auto input = sl::io::span<const char>(input_str.data(), 0);
+    bool binary_output = false;
+    if (args[input_idx]->IsString()) {
+        input_str = jsval_to_string(isolate, args[input_idx]);
+        input = sl::io::span<const char>(input_str.data(), input_str.length());
+    } else {
+        input = binary_jsval_to_span(args[input_idx]);
+        binary_output = true;
+    }
+    if (args.Length() > input_idx + 1 && args[input_idx + 1]->IsBoolean()) {
+        binary_output = args[input_idx + 1]->IsTrue();
     }
-    auto name = jsval_to_string(isolate, args[0]);
-    auto input = jsval_to_string(isolate, args[1]);
     // call wilton
     char* out = nullptr;
     int out_len = 0;
-    wilton::support::log_debug("wilton.wiltoncall." + name,
-            "Performing a call, input length: [" + sl::support::to_string(input.length()) + "] ...");
+    auto& name = binding.name;
+    bool debug = binding.debug.is_enabled();
+    if (debug) {
+        wilton::support::log_debug(binding.debug.name(),
+                "Performing a call, input length: [" + sl::support::to_string(input.size()) + "] ...");
+    }
+    auto call_start = std::chrono::steady_clock::now();
     auto err = wiltoncall(name.c_str(), static_cast<int> (name.length()),
-            input.c_str(), static_cast<int> (input.length()),
+            input.data(), static_cast<int> (input.size()),
             std::addressof(out), std::addressof(out_len));
-    wilton::support::log_debug("wilton.wiltoncall." + name,
-            "Call complete, result: [" + (nullptr != err ? std::string(err) : "") + "]");
+    if (nullptr != binding.hist) {
+        binding.hist->record_since(call_start);
+    }
+    if (debug) {
+        wilton::support::log_debug(binding.debug.name(),
+                "Call complete, result: [" + (nullptr != err ? std::string(err) : "") + "]");
+    }
     if (nullptr == err) {
         if (nullptr != out) {
-            auto deferred = sl::support::defer([out]() STATICLIB_NOEXCEPT {
-                wilton_free(out);
-            });
-            auto jout = string_to_jsval(isolate, out, static_cast<size_t>(out_len));
-            args.GetReturnValue().Set(jout);
+            if (binary_output) {
+                auto jout = wilton_buffer_to_jsval(isolate, out, out_len);
+                args.GetReturnValue().Set(jout);
+            } else {
+                auto deferred = sl::support::defer([out]() STATICLIB_NOEXCEPT {
+                    wilton_free(out);
+                });
+                auto jout = string_to_jsval(isolate, out, static_cast<size_t>(out_len));
+                args.GetReturnValue().Set(jout);
+            }
         } else {
             args.GetReturnValue().Set(v8::Null(isolate));
         }
@@ -256,92 +659,1210 @@ void wiltoncall_func(const v8::FunctionCallbackInfo<v8::Value>& args) STATICLIB_
     }
 }
 
+void bound_wiltoncall_func(const v8::FunctionCallbackInfo<v8::Value>& args) STATICLIB_NOEXCEPT {
+    auto isolate = args.GetIsolate();
+    v8::HandleScope handle_scope(isolate);
+    auto ctx = isolate->GetCurrentContext();
+    v8::Context::Scope ctx_scope(ctx);
+    if (args.Length() < 1 || !(args[0]->IsString() || is_binary_jsval(args[0]))) {
+        auto msg = TRACEMSG("Invalid arguments specified");
+        throw_js_exception(ctx, msg);
+        return;
+    }
+    auto binding = static_cast<native_binding*>(v8::Local<v8::External>::Cast(args.Data())->Value());
+    perform_wiltoncall(args, 0, *binding);
+}
+
+// bound when the call cache is full, name is kept in function data
+void uncached_wiltoncall_func(const v8::FunctionCallbackInfo<v8::Value>& args) STATICLIB_NOEXCEPT {
+    auto isolate = args.GetIsolate();
+    v8::HandleScope handle_scope(isolate);
+    auto ctx = isolate->GetCurrentContext();
+    v8::Context::Scope ctx_scope(ctx);
+    if (args.Length() < 1 || !(args[0]->IsString() || is_binary_jsval(args[0]))) {
+        auto msg = TRACEMSG("Invalid arguments specified");
+        throw_js_exception(ctx, msg);
+        return;
+    }
+    auto name = jsval_to_string(isolate, args.Data());
+    auto metrics = v8_metrics::of_isolate(isolate);
+    native_binding binding(name, nullptr != metrics ? std::addressof(metrics->wiltoncall(name)) : nullptr);
+    perform_wiltoncall(args, 0, binding);
+}
+
+/**
+ * Per-isolate data of the native calls: call sites resolved by name,
+ * functions bound to wiltoncall names and interned property names,
+ * entries are created on first use and cached for the lifetime of the isolate,
+ * number of cached names is limited with 'call_sites_max_count'
+ */
+class call_cache {
+    class entry {
+    public:
+        std::unique_ptr<native_binding> binding;
+        v8::Global<v8::Function> fun;
+    };
+
+    std::unordered_map<std::string, std::unique_ptr<entry>> entries;
+    v8::Eternal<v8::String> keys[static_cast<size_t>(property_key::count)];
+    v8::Global<v8::Function> error_ctor;
+
+public:
+    ~call_cache() STATICLIB_NOEXCEPT {
+        for (auto& en : entries) {
+            en.second->fun.Reset();
+        }
+        error_ctor.Reset();
+    }
+
+    // returns nullptr if the name is not cached and the cache is full
+    native_binding* call_site(v8::Isolate* isolate, const std::string& name) {
+        auto it = entries.find(name);
+        if (entries.end() != it) {
+            return it->second->binding.get();
+        }
+        if (entries.size() >= call_sites_max_count) {
+            return nullptr;
+        }
+        auto metrics = v8_metrics::of_isolate(isolate);
+        auto hist = nullptr != metrics ? std::addressof(metrics->wiltoncall(name)) : nullptr;
+        auto en = std::unique_ptr<entry>(new entry());
+        en->binding = std::unique_ptr<native_binding>(new native_binding(name, hist));
+        auto res = en->binding.get();
+        entries.emplace(name, std::move(en));
+        return res;
+    }
+
+    v8::MaybeLocal<v8::Function> bind(v8::Local<v8::Context> ctx, const std::string& name) {
+        auto isolate = ctx->GetIsolate();
+        v8::EscapableHandleScope handle_scope(isolate);
+        auto binding = call_site(isolate, name);
+        if (nullptr == binding) {
+            auto tmpl = v8::FunctionTemplate::New(isolate, uncached_wiltoncall_func,
+                    string_to_jsval(isolate, name));
+            auto fun_maybe = tmpl->GetFunction(ctx);
+            if (fun_maybe.IsEmpty()) {
+                return v8::MaybeLocal<v8::Function>();
+            }
+            return handle_scope.Escape(fun_maybe.ToLocalChecked());
+        }
+        auto& en = entries.find(name)->second;
+        if (!en->fun.IsEmpty()) {
+            return handle_scope.Escape(v8::Local<v8::Function>::New(isolate, en->fun));
+        }
+        auto data = v8::External::New(isolate, binding);
+        auto tmpl = v8::FunctionTemplate::New(isolate, bound_wiltoncall_func, data);
+        auto fun_maybe = tmpl->GetFunction(ctx);
+        if (fun_maybe.IsEmpty()) {
+            return v8::MaybeLocal<v8::Function>();
+        }
+        auto fun = fun_maybe.ToLocalChecked();
+        en->fun.Reset(isolate, fun);
+        return handle_scope.Escape(fun);
+    }
+
+    v8::Local<v8::String> key(v8::Isolate* isolate, property_key id) {
+        auto& ke = keys[static_cast<size_t>(id)];
+        if (ke.IsEmpty()) {
+            auto str = v8::String::NewFromUtf8(isolate, property_key_names[static_cast<size_t>(id)],
+                    v8::NewStringType::kInternalized).ToLocalChecked();
+            ke.Set(isolate, str);
+        }
+        return ke.Get(isolate);
+    }
+
+    v8::MaybeLocal<v8::Object> new_error(v8::Local<v8::Context> ctx) {
+        auto isolate = ctx->GetIsolate();
+        v8::EscapableHandleScope handle_scope(isolate);
+        if (error_ctor.IsEmpty()) {
+            auto ctor_maybe = create_error_ctor(ctx);
+            if (ctor_maybe.IsEmpty()) {
+                return v8::MaybeLocal<v8::Object>();
+            }
+            error_ctor.Reset(isolate, ctor_maybe.ToLocalChecked());
+        }
+        auto ctor = v8::Local<v8::Function>::New(isolate, error_ctor);
+        auto err_maybe = ctor->NewInstance(ctx);
+        if (err_maybe.IsEmpty()) {
+            return v8::MaybeLocal<v8::Object>();
+        }
+        return handle_scope.Escape(err_maybe.ToLocalChecked());
+    }
+
+    static call_cache* of_isolate(v8::Isolate* isolate) {
+        return static_cast<call_cache*>(isolate->GetData(call_cache_isolate_slot));
+    }
+
+private:
+    // instances have 'message' and 'stack' in their initial map and
+    // the error with captured stack in the internal field
+    v8::MaybeLocal<v8::Function> create_error_ctor(v8::Local<v8::Context> ctx) {
+        auto isolate = ctx->GetIsolate();
+        v8::EscapableHandleScope handle_scope(isolate);
+        auto error_key = string_to_jsval(isolate, "Error");
+        auto tmpl = v8::FunctionTemplate::New(isolate);
+        tmpl->SetClassName(error_key);
+        auto inst = tmpl->InstanceTemplate();
+        inst->SetInternalFieldCount(1);
+        inst->Set(key(isolate, property_key::message), v8::String::Empty(isolate));
+        inst->SetLazyDataProperty(key(isolate, property_key::stack), native_error_stack_getter);
+        auto ctor_maybe = tmpl->GetFunction(ctx);
+        auto error_fun_maybe = ctx->Global()->Get(ctx, error_key);
+        if (ctor_maybe.IsEmpty() || error_fun_maybe.IsEmpty() || !error_fun_maybe.ToLocalChecked()->IsFunction()) {
+            return v8::MaybeLocal<v8::Function>();
+        }
+        auto ctor = ctor_maybe.ToLocalChecked();
+        auto error_fun = v8::Local<v8::Function>::Cast(error_fun_maybe.ToLocalChecked());
+        auto proto_key = string_to_jsval(isolate, "prototype");
+        auto proto_maybe = ctor->Get(ctx, proto_key);
+        auto error_proto_maybe = error_fun->Get(ctx, proto_key);
+        if (proto_maybe.IsEmpty() || error_proto_maybe.IsEmpty() || !proto_maybe.ToLocalChecked()->IsObject()) {
+            return v8::MaybeLocal<v8::Function>();
+        }
+        auto proto = v8::Local<v8::Object>::Cast(proto_maybe.ToLocalChecked());
+        // 'instanceof Error', 'name' and 'toString' come from Error.prototype
+        if (!proto->SetPrototype(ctx, error_proto_maybe.ToLocalChecked()).FromMaybe(false)) {
+            return v8::MaybeLocal<v8::Function>();
+        }
+        proto->Set(ctx, string_to_jsval(isolate, "constructor"), error_fun).FromMaybe(false);
+        return handle_scope.Escape(ctor);
+    }
+
+    static void native_error_stack_getter(v8::Local<v8::Name>,
+            const v8::PropertyCallbackInfo<v8::Value>& info) STATICLIB_NOEXCEPT {
+        auto isolate = info.GetIsolate();
+        v8::HandleScope handle_scope(isolate);
+        auto ctx = isolate->GetCurrentContext();
+        auto err = info.Holder();
+        auto captured = err->GetInternalField(0);
+        if (!captured->IsObject()) {
+            info.GetReturnValue().Set(v8::String::Empty(isolate));
+            return;
+        }
+        // formatted by V8 on this read, the getter is replaced with the result
+        auto stack_maybe = v8::Local<v8::Object>::Cast(captured)->Get(ctx,
+                key_to_jsval(isolate, property_key::stack));
+        if (stack_maybe.IsEmpty()) {
+            return;
+        }
+        err->SetInternalField(0, v8::Undefined(isolate));
+        auto stack = filter_stack_trace(jsval_to_string(isolate, stack_maybe.ToLocalChecked()));
+        info.GetReturnValue().Set(string_to_jsval(isolate, stack));
+    }
+};
+
+v8::MaybeLocal<v8::Object> new_native_error(v8::Local<v8::Context> ctx) {
+    auto cache = call_cache::of_isolate(ctx->GetIsolate());
+    if (nullptr != cache) {
+        return cache->new_error(ctx);
+    }
+    return v8::MaybeLocal<v8::Object>();
+}
+
+// cache is not available while snapshot is created
+v8::Local<v8::String> key_to_jsval(v8::Isolate* isolate, property_key id) {
+    auto cache = call_cache::of_isolate(isolate);
+    if (nullptr != cache) {
+        return cache->key(isolate, id);
+    }
+    return string_to_jsval(isolate, property_key_names[static_cast<size_t>(id)]);
+}
+
+void wiltoncall_func(const v8::FunctionCallbackInfo<v8::Value>& args) STATICLIB_NOEXCEPT {
+    auto isolate = args.GetIsolate();
+    v8::HandleScope handle_scope(isolate);
+    auto ctx = isolate->GetCurrentContext();
+    v8::Context::Scope ctx_scope(ctx);
+    if (args.Length() < 2 || !args[0]->IsString() || !(args[1]->IsString() || is_binary_jsval(args[1]))) {
+        auto msg = TRACEMSG("Invalid arguments specified");
+        throw_js_exception(ctx, msg);
+        return;
+    }
+    auto name = jsval_to_string(isolate, args[0]);
+    auto cache = call_cache::of_isolate(isolate);
+    auto cached = nullptr != cache ? cache->call_site(isolate, name) : nullptr;
+    if (nullptr != cached) {
+        perform_wiltoncall(args, 1, *cached);
+    } else {
+        auto metrics = v8_metrics::of_isolate(isolate);
+        native_binding binding(name, nullptr != metrics ? std::addressof(metrics->wiltoncall(name)) : nullptr);
+        perform_wiltoncall(args, 1, binding);
+    }
+}
+
+void wiltoncall_bind_func(const v8::FunctionCallbackInfo<v8::Value>& args) STATICLIB_NOEXCEPT {
+    auto isolate = args.GetIsolate();
+    v8::HandleScope handle_scope(isolate);
+    auto ctx = isolate->GetCurrentContext();
+    v8::Context::Scope ctx_scope(ctx);
+    if (args.Length() < 1 || !args[0]->IsString()) {
+        auto msg = TRACEMSG("Invalid arguments specified");
+        throw_js_exception(ctx, msg);
+        return;
+    }
+    // not available while snapshot is created, bindings cannot be serialized
+    auto cache = call_cache::of_isolate(isolate);
+    if (nullptr == cache) {
+        auto msg = TRACEMSG("Native bindings are not available in this context");
+        throw_js_exception(ctx, msg);
+        return;
+    }
+    auto name = jsval_to_string(isolate, args[0]);
+    auto fun_maybe = cache->bind(ctx, name);
+    if (!fun_maybe.IsEmpty()) {
+        args.GetReturnValue().Set(fun_maybe.ToLocalChecked());
+    }
+}
+
+const uint32_t event_loop_isolate_slot = 1;
+
+class pending_call {
+public:
+    v8::Global<v8::Promise::Resolver> resolver;
+    std::string name;
+    bool binary_output;
+
+    pending_call(v8::Isolate* isolate, v8::Local<v8::Promise::Resolver> resolver,
+            const std::string& name, bool binary_output) :
+    resolver(isolate, resolver),
+    name(name),
+    binary_output(binary_output) { }
+};
+
+/**
+ * Async wiltoncalls started by the engine, pumped from 'run_callback_script'
+ */
+class event_loop {
+public:
+    std::shared_ptr<v8_completion_queue> queue = std::make_shared<v8_completion_queue>();
+    std::unordered_map<uint64_t, pending_call> pending;
+    uint64_t next_id = 0;
+    // wall time limit for waiting on completions in the current callback
+    std::chrono::steady_clock::time_point deadline = std::chrono::steady_clock::time_point::max();
+
+    static event_loop* of_isolate(v8::Isolate* isolate) {
+        return static_cast<event_loop*>(isolate->GetData(event_loop_isolate_slot));
+    }
+
+    void run_completions(v8::Local<v8::Context>& ctx, bool wait) {
+        auto isolate = ctx->GetIsolate();
+        v8::HandleScope handle_scope(isolate);
+        for (auto& co : queue->take_all(wait, deadline)) {
+            auto it = pending.find(co.id);
+            if (pending.end() == it) {
+                continue;
+            }
+            auto resolver = v8::Local<v8::Promise::Resolver>::New(isolate, it->second.resolver);
+            if (co.error.empty()) {
+                auto res = v8::Local<v8::Value>(v8::Null(isolate));
+                if (nullptr != co.output.get()) {
+                    if (it->second.binary_output) {
+                        res = wilton_buffer_to_jsval(isolate, co.output.release(), co.output_len);
+                    } else {
+                        res = string_to_jsval(isolate, co.output.get(), static_cast<size_t>(co.output_len));
+                    }
+                }
+                resolver->Resolve(ctx, res).FromMaybe(false);
+            } else {
+                auto msg = TRACEMSG(co.error + "\n'wiltoncall' error for name: [" + it->second.name + "]");
+                resolver->Reject(ctx, create_js_error(ctx, msg)).FromMaybe(false);
+            }
+            it->second.resolver.Reset();
+            pending.erase(it);
+        }
+        isolate->RunMicrotasks();
+    }
+
+    v8::Local<v8::Value> await(v8::Local<v8::Context>& ctx, v8::Local<v8::Promise> promise) {
+        auto isolate = ctx->GetIsolate();
+        v8::EscapableHandleScope handle_scope(isolate);
+        isolate->RunMicrotasks();
+        while (v8::Promise::kPending == promise->State()) {
+            // termination is requested while the thread is blocked outside of JS,
+            // so the watchdog interrupts the queue wait instead
+            if (isolate->IsExecutionTerminating() || queue->is_interrupted()) {
+                throw support::exception(TRACEMSG("Callback script execution terminated"));
+            }
+            if (pending.empty()) {
+                throw support::exception(TRACEMSG("Promise returned from callback script" +
+                        " cannot be settled, no async calls are in progress"));
+            }
+            if (std::chrono::steady_clock::now() >= deadline) {
+                throw support::exception(TRACEMSG("Callback script execution timed out" +
+                        " waiting for async calls, pending: [" + sl::support::to_string(pending.size()) + "]"));
+            }
+            run_completions(ctx, true);
+        }
+        if (v8::Promise::kRejected == promise->State()) {
+            auto reason = promise->Result();
+            auto msg = jsval_to_string(isolate, reason);
+            if (reason->IsObject()) {
+                auto stack_maybe = v8::Local<v8::Object>::Cast(reason)->Get(ctx, key_to_jsval(isolate, property_key::stack));
+                if (!stack_maybe.IsEmpty() && stack_maybe.ToLocalChecked()->IsString()) {
+                    auto stack = jsval_to_string(isolate, stack_maybe.ToLocalChecked());
+                    if (!stack.empty()) {
+                        msg = stack;
+                    }
+                }
+            }
+            throw support::exception(TRACEMSG("Promise returned from callback script rejected: " + msg));
+        }
+        return handle_scope.Escape(promise->Result());
+    }
+};
+
+// single item of 'WILTON_wiltoncall_batch', result is stored
+// in the same form that is used for async calls
+class batch_call {
+public:
+    std::string name;
+    std::string input_str;
+    sl::io::span<const char> input = sl::io::span<const char>("", 0);
+    bool binary_output = false;
+    v8_async_completion result;
+};
+
+std::vector<batch_call> read_batch_calls(v8::Local<v8::Context> ctx, v8::Local<v8::Array> items,
+        bool copy_input) {
+    auto isolate = ctx->GetIsolate();
+    v8::HandleScope handle_scope(isolate);
+    auto name_key = key_to_jsval(isolate, property_key::name);
+    auto input_key = key_to_jsval(isolate, property_key::input);
+    auto binary_key = key_to_jsval(isolate, property_key::binary_output);
+    auto res = std::vector<batch_call>();
+    res.resize(items->Length());
+    for (uint32_t i = 0; i < items->Length(); i++) {
+        auto idx = sl::support::to_string(i);
+        auto item = items->Get(ctx, i).FromMaybe(v8::Local<v8::Value>());
+        if (item.IsEmpty() || !item->IsObject()) {
+            throw support::exception(TRACEMSG("Invalid batch item, index: [" + idx + "]"));
+        }
+        auto obj = v8::Local<v8::Object>::Cast(item);
+        auto name = obj->Get(ctx, name_key).FromMaybe(v8::Local<v8::Value>());
+        auto input = obj->Get(ctx, input_key).FromMaybe(v8::Local<v8::Value>());
+        if (name.IsEmpty() || !name->IsString() || input.IsEmpty() ||
+                !(input->IsString() || is_binary_jsval(input))) {
+            throw support::exception(TRACEMSG("Invalid batch item, 'name' and 'input' must be specified," +
+                    " index: [" + idx + "]"));
+        }
+        auto& call = res[i];
+        call.name = jsval_to_string(isolate, name);
+        if (input->IsString()) {
+            call.input_str = jsval_to_string(isolate, input);
+            call.input = sl::io::span<const char>(call.input_str.data(), call.input_str.length());
+        } else {
+            // binary input is copied only when it is going to be passed to other threads,
+            // backing stores cannot be detached while the batch is running
+            auto span = binary_jsval_to_span(input);
+            if (copy_input) {
+                call.input_str = std::string(span.data(), span.size());
+                call.input = sl::io::span<const char>(call.input_str.data(), call.input_str.length());
+            } else {
+                call.input = span;
+            }
+            call.binary_output = true;
+        }
+        auto binary = obj->Get(ctx, binary_key).FromMaybe(v8::Local<v8::Value>());
+        if (!binary.IsEmpty() && binary->IsBoolean()) {
+            call.binary_output = binary->IsTrue();
+        }
+    }
+    return res;
+}
+
+void run_batch_call(batch_call& call) {
+    char* out = nullptr;
+    int out_len = 0;
+    auto err = wiltoncall(call.name.c_str(), static_cast<int> (call.name.length()),
+            call.input.data(), static_cast<int> (call.input.size()),
+            std::addressof(out), std::addressof(out_len));
+    if (nullptr == err) {
+        call.result.output.reset(out);
+        call.result.output_len = out_len;
+    } else {
+        call.result.error = std::string(err);
+        wilton_free(err);
+    }
+}
+
+void run_batch_sequential(std::vector<batch_call>& calls, v8_metrics* metrics) {
+    for (auto& call : calls) {
+        auto call_start = std::chrono::steady_clock::now();
+        run_batch_call(call);
+        if (nullptr != metrics) {
+            metrics->wiltoncall(call.name).record_since(call_start);
+        }
+    }
+}
+
+// items are posted to the event loop queue, so the wait is bounded
+// by the callback deadline and is interrupted by the watchdog
+void run_batch_parallel(std::vector<batch_call>& calls, v8_metrics* metrics, event_loop& loop) {
+    auto first_id = loop.next_id;
+    loop.next_id += calls.size();
+    auto& executor = v8_async_executor::shared();
+    for (size_t i = 1; i < calls.size(); i++) {
+        auto& call = calls[i];
+        executor.submit_wiltoncall(loop.queue, first_id + i, call.name, std::move(call.input_str));
+    }
+    // first call is run on the calling thread, progress does not
+    // depend on the executor when it is busy with other calls
+    auto first_start = std::chrono::steady_clock::now();
+    run_batch_call(calls.front());
+    calls.front().result.elapsed_us = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::steady_clock::now() - first_start).count());
+    // completions of async calls taken meanwhile are returned to the queue
+    auto others = std::vector<v8_async_completion>();
+    auto deferred = sl::support::defer([&loop, &others] () STATICLIB_NOEXCEPT {
+        for (auto& co : others) {
+            loop.queue->post(std::move(co));
+        }
+    });
+    size_t remaining = calls.size() - 1;
+    while (remaining > 0) {
+        // items left running are dropped by the event loop when they complete
+        if (loop.queue->is_interrupted()) {
+            throw support::exception(TRACEMSG("Callback script execution terminated"));
+        }
+        if (std::chrono::steady_clock::now() >= loop.deadline) {
+            throw support::exception(TRACEMSG("Callback script execution timed out" +
+                    " waiting for batch items, pending: [" + sl::support::to_string(remaining) + "]"));
+        }
+        for (auto& co : loop.queue->take_all(true, loop.deadline)) {
+            if (co.id > first_id && co.id - first_id < calls.size()) {
+                calls[static_cast<size_t>(co.id - first_id)].result = std::move(co);
+                remaining -= 1;
+            } else {
+                others.emplace_back(std::move(co));
+            }
+        }
+    }
+    // each item is timed on the thread that performed it
+    if (nullptr != metrics) {
+        for (auto& call : calls) {
+            metrics->wiltoncall(call.name).record(call.result.elapsed_us);
+        }
+    }
+}
+
+// WILTON_wiltoncall_batch([{name, input, binaryOutput}, ...], parallel)
+// returns an array of {result} or {error} objects in the order of input items
+void wiltoncall_batch_func(const v8::FunctionCallbackInfo<v8::Value>& args) STATICLIB_NOEXCEPT {
+    auto isolate = args.GetIsolate();
+    v8::HandleScope handle_scope(isolate);
+    auto ctx = isolate->GetCurrentContext();
+    v8::Context::Scope ctx_scope(ctx);
+    if (args.Length() < 1 || !args[0]->IsArray()) {
+        auto msg = TRACEMSG("Invalid arguments specified");
+        throw_js_exception(ctx, msg);
+        return;
+    }
+    bool parallel = args.Length() > 1 && args[1]->IsTrue();
+    static debug_level logger("wilton.wiltoncall.batch");
+    try {
+        auto calls = read_batch_calls(ctx, v8::Local<v8::Array>::Cast(args[0]), parallel);
+        bool debug = logger.is_enabled();
+        if (debug) {
+            wilton::support::log_debug(logger.name(), "Performing a batch call," +
+                    std::string(" items: [") + sl::support::to_string(calls.size()) + "]," +
+                    " parallel: [" + sl::support::to_string_bool(parallel) + "] ...");
+        }
+        auto metrics = v8_metrics::of_isolate(isolate);
+        auto loop = event_loop::of_isolate(isolate);
+        // executor thread waiting for other executor tasks can deadlock
+        // the pool, nested batches are run inline
+        if (parallel && calls.size() > 1 && nullptr != loop && !v8_async_executor::is_worker_thread()) {
+            run_batch_parallel(calls, metrics, *loop);
+        } else {
+            run_batch_sequential(calls, metrics);
+        }
+        if (debug) {
+            wilton::support::log_debug(logger.name(), "Batch call complete");
+        }
+        auto result_key = key_to_jsval(isolate, property_key::result);
+        auto error_key = key_to_jsval(isolate, property_key::error);
+        auto res = v8::Array::New(isolate, static_cast<int>(calls.size()));
+        for (size_t i = 0; i < calls.size(); i++) {
+            auto& co = calls[i].result;
+            auto item = v8::Object::New(isolate);
+            if (co.error.empty()) {
+                auto val = v8::Local<v8::Value>(v8::Null(isolate));
+                if (nullptr != co.output.get()) {
+                    if (calls[i].binary_output) {
+                        val = wilton_buffer_to_jsval(isolate, co.output.release(), co.output_len);
+                    } else {
+                        val = string_to_jsval(isolate, co.output.get(), static_cast<size_t>(co.output_len));
+                    }
+                }
+                item->Set(ctx, result_key, val).FromMaybe(false);
+            } else {
+                auto msg = TRACEMSG(co.error + "\n'wiltoncall' error for name: [" + calls[i].name + "]");
+                item->Set(ctx, error_key, create_js_error(ctx, msg)).FromMaybe(false);
+            }
+            res->Set(ctx, static_cast<uint32_t>(i), item).FromMaybe(false);
+        }
+        args.GetReturnValue().Set(res);
+    } catch (const std::exception& e) {
+        auto msg = TRACEMSG(e.what() + "\nError performing batch call");
+        throw_js_exception(ctx, msg);
+    }
+}
+
+void wiltoncall_async_func(const v8::FunctionCallbackInfo<v8::Value>& args) STATICLIB_NOEXCEPT {
+    auto isolate = args.GetIsolate();
+    v8::HandleScope handle_scope(isolate);
+    auto ctx = isolate->GetCurrentContext();
+    v8::Context::Scope ctx_scope(ctx);
+    if (args.Length() < 2 || !args[0]->IsString() || !(args[1]->IsString() || is_binary_jsval(args[1]))) {
+        auto msg = TRACEMSG("Invalid arguments specified");
+        throw_js_exception(ctx, msg);
+        return;
+    }
+    auto loop = event_loop::of_isolate(isolate);
+    auto resolver_maybe = v8::Promise::Resolver::New(ctx);
+    if (nullptr == loop || resolver_maybe.IsEmpty()) {
+        auto msg = TRACEMSG("Async calls are not available in this context");
+        throw_js_exception(ctx, msg);
+        return;
+    }
+    auto resolver = resolver_maybe.ToLocalChecked();
+    auto name = jsval_to_string(isolate, args[0]);
+    // input is copied, worker thread must not access JS heap
+    auto input = std::string();
+    bool binary_output = false;
+    if (args[1]->IsString()) {
+        input = jsval_to_string(isolate, args[1]);
+    } else {
+        auto span = binary_jsval_to_span(args[1]);
+        input = std::string(span.data(), span.size());
+        binary_output = true;
+    }
+    if (args.Length() > 2 && args[2]->IsBoolean()) {
+        binary_output = args[2]->IsTrue();
+    }
+    auto id = loop->next_id++;
+    loop->pending.insert(std::make_pair(id, pending_call(isolate, resolver, name, binary_output)));
+    try {
+        v8_async_executor::shared().submit_wiltoncall(loop->queue, id, std::move(name), std::move(input));
+    } catch (const std::exception& e) {
+        loop->pending.erase(id);
+        auto msg = TRACEMSG(e.what() + "\nError starting async call");
+        throw_js_exception(ctx, msg);
+        return;
+    }
+    args.GetReturnValue().Set(resolver->GetPromise());
+}
+
+int64_t timeout_jsval(v8::Local<v8::Context>& ctx, const v8::Local<v8::Value>& value) {
+    if (value->IsNumber()) {
+        return value->IntegerValue(ctx).FromMaybe(-1);
+    }
+    return -1;
+}
+
+// blocking channel operations do not outlive the callback budget
+int64_t bounded_timeout(v8::Isolate* isolate, int64_t timeout_ms) {
+    auto loop = event_loop::of_isolate(isolate);
+    if (nullptr == loop || std::chrono::steady_clock::time_point::max() == loop->deadline) {
+        return timeout_ms;
+    }
+    auto remaining = std::chrono::duration_cast<std::chrono::milliseconds>(
+            loop->deadline - std::chrono::steady_clock::now()).count();
+    remaining = std::max(remaining, static_cast<decltype(remaining)>(0));
+    if (timeout_ms < 0 || timeout_ms > remaining) {
+        return static_cast<int64_t>(remaining);
+    }
+    return timeout_ms;
+}
+
+// isolate lock is released while the thread is blocked on the channel
+std::unique_ptr<v8::Unlocker> unlock_isolate(v8::Isolate* isolate) {
+    if (!v8::Locker::IsLocked(isolate)) {
+        return std::unique_ptr<v8::Unlocker>();
+    }
+    return std::unique_ptr<v8::Unlocker>(new v8::Unlocker(isolate));
+}
+
+void channel_create_func(const v8::FunctionCallbackInfo<v8::Value>& args) STATICLIB_NOEXCEPT {
+    auto isolate = args.GetIsolate();
+    v8::HandleScope handle_scope(isolate);
+    auto ctx = isolate->GetCurrentContext();
+    v8::Context::Scope ctx_scope(ctx);
+    try {
+        if (args.Length() < 2 || !args[0]->IsString() || !args[1]->IsNumber()) {
+            throw support::exception(TRACEMSG("Invalid arguments specified"));
+        }
+        auto name = jsval_to_string(isolate, args[0]);
+        auto capacity = args[1]->IntegerValue(ctx).FromMaybe(0);
+        if (capacity <= 0) {
+            throw support::exception(TRACEMSG("Invalid channel capacity specified," +
+                    " name: [" + name + "], capacity: [" + sl::support::to_string(capacity) + "]"));
+        }
+        v8_channel_registry::shared().create(name, static_cast<size_t>(capacity));
+    } catch (const std::exception& e) {
+        auto msg = TRACEMSG(e.what() + "\nError creating channel");
+        throw_js_exception(ctx, msg);
+    }
+}
+
+void channel_send_func(const v8::FunctionCallbackInfo<v8::Value>& args) STATICLIB_NOEXCEPT {
+    auto isolate = args.GetIsolate();
+    v8::HandleScope handle_scope(isolate);
+    auto ctx = isolate->GetCurrentContext();
+    v8::Context::Scope ctx_scope(ctx);
+    try {
+        if (args.Length() < 2 || !args[0]->IsString()) {
+            throw support::exception(TRACEMSG("Invalid arguments specified"));
+        }
+        auto name = jsval_to_string(isolate, args[0]);
+        auto channel = v8_channel_registry::shared().find(name);
+        auto transfer_list = args.Length() > 2 ? args[2] : v8::Local<v8::Value>();
+        auto timeout = args.Length() > 3 ? timeout_jsval(ctx, args[3]) : -1;
+        auto message = serialize_channel_message(ctx, args[1], transfer_list);
+        bool sent = !channel->is_closed() && channel->try_send(message);
+        if (!sent && 0 != timeout && !channel->is_closed()) {
+            auto bounded = bounded_timeout(isolate, timeout);
+            auto unlocker = unlock_isolate(isolate);
+            sent = channel->send(message, bounded);
+        }
+        if (!sent && channel->is_closed()) {
+            throw support::exception(TRACEMSG("Channel is closed, name: [" + name + "]"));
+        }
+        args.GetReturnValue().Set(sent);
+    } catch (const std::exception& e) {
+        auto msg = TRACEMSG(e.what() + "\nError sending channel message");
+        throw_js_exception(ctx, msg);
+    }
+}
+
+void channel_receive_func(const v8::FunctionCallbackInfo<v8::Value>& args) STATICLIB_NOEXCEPT {
+    auto isolate = args.GetIsolate();
+    v8::HandleScope handle_scope(isolate);
+    auto ctx = isolate->GetCurrentContext();
+    v8::Context::Scope ctx_scope(ctx);
+    try {
+        if (args.Length() < 1 || !args[0]->IsString()) {
+            throw support::exception(TRACEMSG("Invalid arguments specified"));
+        }
+        auto name = jsval_to_string(isolate, args[0]);
+        auto channel = v8_channel_registry::shared().find(name);
+        auto timeout = args.Length() > 1 ? timeout_jsval(ctx, args[1]) : -1;
+        auto message = v8_channel_message();
+        bool received = channel->try_receive(message);
+        if (!received && 0 != timeout && !channel->is_closed()) {
+            auto bounded = bounded_timeout(isolate, timeout);
+            auto unlocker = unlock_isolate(isolate);
+            received = channel->receive(message, bounded);
+        }
+        // undefined is returned on timeout and when closed channel is empty
+        if (received) {
+            auto value = deserialize_channel_message(ctx, message);
+            args.GetReturnValue().Set(value);
+        }
+    } catch (const std::exception& e) {
+        auto msg = TRACEMSG(e.what() + "\nError receiving channel message");
+        throw_js_exception(ctx, msg);
+    }
+}
+
+void channel_close_func(const v8::FunctionCallbackInfo<v8::Value>& args) STATICLIB_NOEXCEPT {
+    auto isolate = args.GetIsolate();
+    v8::HandleScope handle_scope(isolate);
+    auto ctx = isolate->GetCurrentContext();
+    v8::Context::Scope ctx_scope(ctx);
+    try {
+        if (args.Length() < 1 || !args[0]->IsString()) {
+            throw support::exception(TRACEMSG("Invalid arguments specified"));
+        }
+        auto name = jsval_to_string(isolate, args[0]);
+        bool existed = v8_channel_registry::shared().close(name);
+        args.GetReturnValue().Set(existed);
+    } catch (const std::exception& e) {
+        auto msg = TRACEMSG(e.what() + "\nError closing channel");
+        throw_js_exception(ctx, msg);
+    }
+}
+
+void gc_prologue(v8::Isolate*, v8::GCType, v8::GCCallbackFlags, void* data) {
+    auto metrics = static_cast<v8_metrics*>(data);
+    metrics->gc_started();
+}
+
+void gc_epilogue(v8::Isolate* isolate, v8::GCType type, v8::GCCallbackFlags, void* data) {
+    auto metrics = static_cast<v8_metrics*>(data);
+    metrics->gc_finished(isolate, type);
+}
+
+// native callbacks must be registered with the snapshot
+// to be resolved when isolates are deserialized
+const intptr_t external_references[] = {
+    reinterpret_cast<intptr_t>(print_func),
+    reinterpret_cast<intptr_t>(load_func),
+    reinterpret_cast<intptr_t>(wiltoncall_func),
+    reinterpret_cast<intptr_t>(wiltoncall_batch_func),
+    reinterpret_cast<intptr_t>(wiltoncall_bind_func),
+    reinterpret_cast<intptr_t>(bound_wiltoncall_func),
+    reinterpret_cast<intptr_t>(uncached_wiltoncall_func),
+    reinterpret_cast<intptr_t>(wiltoncall_async_func),
+    reinterpret_cast<intptr_t>(channel_create_func),
+    reinterpret_cast<intptr_t>(channel_send_func),
+    reinterpret_cast<intptr_t>(channel_receive_func),
+    reinterpret_cast<intptr_t>(channel_close_func),
+    0
+};
+
+v8::Local<v8::ObjectTemplate> create_global_template(v8::Isolate* isolate) {
+    v8::EscapableHandleScope handle_scope(isolate);
+    auto global = v8::ObjectTemplate::New(isolate);
+    global->Set(string_to_jsval(isolate, "print"), v8::FunctionTemplate::New(isolate, print_func));
+    global->Set(string_to_jsval(isolate, "WILTON_load"), v8::FunctionTemplate::New(isolate, load_func));
+    global->Set(string_to_jsval(isolate, "WILTON_wiltoncall"), v8::FunctionTemplate::New(isolate, wiltoncall_func));
+    global->Set(string_to_jsval(isolate, "WILTON_wiltoncall_batch"), v8::FunctionTemplate::New(isolate, wiltoncall_batch_func));
+    global->Set(string_to_jsval(isolate, "WILTON_wiltoncall_bind"), v8::FunctionTemplate::New(isolate, wiltoncall_bind_func));
+    global->Set(string_to_jsval(isolate, "WILTON_wiltoncall_async"), v8::FunctionTemplate::New(isolate, wiltoncall_async_func));
+    global->Set(string_to_jsval(isolate, "WILTON_channel_create"), v8::FunctionTemplate::New(isolate, channel_create_func));
+    global->Set(string_to_jsval(isolate, "WILTON_channel_send"), v8::FunctionTemplate::New(isolate, channel_send_func));
+    global->Set(string_to_jsval(isolate, "WILTON_channel_receive"), v8::FunctionTemplate::New(isolate, channel_receive_func));
+    global->Set(string_to_jsval(isolate, "WILTON_channel_close"), v8::FunctionTemplate::New(isolate, channel_close_func));
+    return handle_scope.Escape(global);
+}
+
+std::string snapshot_modules_code(const std::string& modules) {
+    auto ids = std::vector<sl::json::value>();
+    for (auto& id : sl::utils::split(modules, ',')) {
+        if (!id.empty()) {
+            ids.emplace_back(id);
+        }
+    }
+    if (ids.empty()) {
+        return std::string();
+    }
+    return "require(" + sl::json::value(std::move(ids)).dumps() + ");";
+}
+
+v8::StartupData create_startup_snapshot(sl::io::span<const char> init_code, const std::string& modules) {
+    v8::Isolate* isolate = nullptr;
+    auto blob = v8::StartupData();
+    {
+#if V8_MAJOR_VERSION > 11 || (V8_MAJOR_VERSION == 11 && V8_MINOR_VERSION >= 4)
+        v8::Isolate::CreateParams create_params;
+        create_params.array_buffer_allocator = shared_array_buffer_allocator();
+        create_params.external_references = external_references;
+        v8::SnapshotCreator creator(create_params);
+#else // older versions
+        // allocator cannot be passed to the creator, it uses the V8 default one,
+        // buffers created by the bootstrap are copied into the snapshot
+        v8::SnapshotCreator creator(external_references);
+#endif
+        isolate = creator.GetIsolate();
+        snapshot_isolate.store(isolate, std::memory_order_release);
+        auto deferred = sl::support::defer([] () STATICLIB_NOEXCEPT {
+            snapshot_isolate.store(nullptr, std::memory_order_release);
+        });
+        {
+            v8::HandleScope handle_scope(isolate);
+            auto global = create_global_template(isolate);
+            auto ctx = v8::Context::New(isolate, nullptr, global);
+            eval_js(ctx, init_code.data(), init_code.size(), "wilton-require.js");
+            // core modules are run once here instead of on first use in every isolate,
+            // their top-level code must not keep native resources
+            auto modules_code = snapshot_modules_code(modules);
+            if (!modules_code.empty()) {
+                eval_js(ctx, modules_code.data(), modules_code.length(), "wilton-snapshot-modules.js");
+            }
+            creator.SetDefaultContext(ctx);
+        }
+        blob = creator.CreateBlob(v8::SnapshotCreator::FunctionCodeHandling::kKeep);
+    }
+    // isolate is disposed by the creator
+    platform->dispose_isolate(isolate);
+    return blob;
+}
+
+// created once per process on first use, all engines
+// are bootstrapped from the same init code
+v8::StartupData* shared_startup_snapshot(sl::io::span<const char> init_code, const std::string& modules) {
+    static std::mutex mutex;
+    static bool attempted = false;
+    static v8::StartupData blob = {nullptr, 0};
+    std::lock_guard<std::mutex> guard{mutex};
+    if (!attempted) {
+        attempted = true;
+        wilton::support::log_info("wilton.engine.v8.snapshot", std::string() + "Creating startup snapshot," +
+                " modules: [" + modules + "] ...");
+        try {
+            blob = create_startup_snapshot(init_code, modules);
+        } catch (const std::exception& e) {
+            wilton::support::log_warn("wilton.engine.v8.snapshot", TRACEMSG(e.what() +
+                    "\nError creating startup snapshot, engines will be initialized without it"));
+        }
+        if (nullptr != blob.data) {
+            wilton::support::log_info("wilton.engine.v8.snapshot", std::string() + "Startup snapshot created," +
+                    " size: [" + sl::support::to_string(blob.raw_size) + "]");
+        }
+    }
+    return nullptr != blob.data ? std::addressof(blob) : nullptr;
+}
+
 } // namespace
 
 class v8_engine::impl : public sl::pimpl::object::impl {
     v8::Isolate* isolate = nullptr;
     v8::Global<v8::Context> ctx_global;
+    v8::Global<v8::Function> run_fun_global;
+    std::shared_ptr<v8_metrics> metrics;
+    std::shared_ptr<v8_cpu_profiler> profiler;
+    std::shared_ptr<v8_heap_profiler> heap_profiler;
+    // released after isolate disposal, outstanding buffers keep their own refs
+    v8_allocation_counters* allocations = nullptr;
+    std::unique_ptr<v8_gc_scheduler> gc;
+    std::unique_ptr<event_loop> loop;
+    std::unique_ptr<call_cache> calls;
+    std::unique_ptr<external_buffer_list> external_buffers;
+    bool payload_objects = false;
+    uint32_t timeout_ms = 0;
+    bool timeout_cpu = false;
+    uint64_t recycle_calls = 0;
+    uint64_t recycle_old_space_bytes = 0;
+    std::chrono::seconds recycle_age{0};
+    uint64_t calls_served = 0;
+    std::chrono::steady_clock::time_point first_call;
 
 public:
 
     ~impl() STATICLIB_NOEXCEPT {
-        ctx_global.Reset();
-        isolate->Dispose();
+        release();
     }
 
     impl(sl::io::span<const char> init_code) {
-        auto cfg = get_config();
+        // destructor is not called when constructor throws
+        try {
+            initialize(init_code);
+        } catch (...) {
+            release();
+            throw;
+        }
+    }
+
+private:
+    void initialize(sl::io::span<const char> init_code) {
+        auto cfg = v8_config::from_wilton_config();
         wilton::support::log_info("wilton.engine.v8.init", std::string() + "Initializing engine instance," +
                 " config: [" + cfg.to_json().dumps() + "]");
+        this->payload_objects = cfg.callback_payload_objects;
+        this->timeout_ms = cfg.callback_timeout_ms;
+        this->timeout_cpu = cfg.callback_timeout_cpu;
+        this->recycle_calls = cfg.recycle_calls;
+        this->recycle_old_space_bytes = static_cast<uint64_t>(cfg.recycle_old_space_mb) * 1024 * 1024;
+        this->recycle_age = std::chrono::seconds(cfg.recycle_age_s);
+        auto start = std::chrono::steady_clock::now();
+        auto snapshot = cfg.startup_snapshot ? shared_startup_snapshot(init_code, cfg.snapshot_modules) : nullptr;
         v8::Isolate::CreateParams create_params;
         set_constraints(create_params.constraints, cfg);
-        create_params.array_buffer_allocator = v8::ArrayBuffer::Allocator::NewDefaultAllocator();
+        create_params.array_buffer_allocator = shared_array_buffer_allocator();
+        if (nullptr != snapshot) {
+            create_params.snapshot_blob = snapshot;
+            create_params.external_references = external_references;
+        }
+        this->allocations = new v8_allocation_counters();
+        v8_allocation_scope creation_scope(allocations, nullptr);
         this->isolate = v8::Isolate::New(create_params);
+        // locking is required, engine may be used from different threads
+        v8::Locker locker(isolate);
+        v8::Isolate::Scope isolate_scope(isolate);
+        v8_allocation_scope allocation_scope(allocations, isolate);
+        this->metrics = std::make_shared<v8_metrics>();
+        v8_metrics::attach_to_isolate(isolate, metrics.get());
+        isolate->AddGCPrologueCallback(gc_prologue, metrics.get());
+        isolate->AddGCEpilogueCallback(gc_epilogue, metrics.get());
+        v8_metrics_registry::shared().add(metrics);
+        auto& profilers = v8_cpu_profiler_registry::shared();
+        this->profiler = std::make_shared<v8_cpu_profiler>(isolate, profilers.next_engine_id());
+        profilers.add(profiler);
+        this->heap_profiler = std::make_shared<v8_heap_profiler>(isolate, profiler->id());
+        v8_heap_profiler_registry::shared().add(heap_profiler);
+        this->gc = std::unique_ptr<v8_gc_scheduler>(new v8_gc_scheduler(isolate, platform, cfg));
+        this->loop = std::unique_ptr<event_loop>(new event_loop());
+        isolate->SetData(event_loop_isolate_slot, loop.get());
+        this->calls = std::unique_ptr<call_cache>(new call_cache());
+        isolate->SetData(call_cache_isolate_slot, calls.get());
+        this->external_buffers = std::unique_ptr<external_buffer_list>(new external_buffer_list());
+        isolate->SetData(external_buffers_isolate_slot, external_buffers.get());
         v8::HandleScope handle_scope(isolate);
-        auto global = v8::ObjectTemplate::New(isolate);
-        global->Set(string_to_jsval(isolate, "print"), v8::FunctionTemplate::New(isolate, print_func));
-        global->Set(string_to_jsval(isolate, "WILTON_load"), v8::FunctionTemplate::New(isolate, load_func));
-        global->Set(string_to_jsval(isolate, "WILTON_wiltoncall"), v8::FunctionTemplate::New(isolate, wiltoncall_func));
-        this->ctx_global = v8::Global<v8::Context>(isolate, v8::Context::New(isolate, nullptr, global));
-        auto ctx = v8::Local<v8::Context>::New(isolate, ctx_global);
-        eval_js(ctx, init_code.data(), init_code.size(), "wilton-require.js");
-        wilton::support::log_info("wilton.engine.v8.init", "Engine initialization complete");
+        if (nullptr != snapshot) {
+            // global functions and bootstrap state are deserialized from snapshot
+            this->ctx_global = v8::Global<v8::Context>(isolate, v8::Context::New(isolate));
+        } else {
+            auto global = create_global_template(isolate);
+            this->ctx_global = v8::Global<v8::Context>(isolate, v8::Context::New(isolate, nullptr, global));
+            auto ctx = v8::Local<v8::Context>::New(isolate, ctx_global);
+            eval_js(ctx, init_code.data(), init_code.size(), "wilton-require.js");
+        }
+        resolve_run_function();
+        update_heap();
+        auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(
+                std::chrono::steady_clock::now() - start);
+        metrics->init.record(static_cast<uint64_t>(elapsed.count()));
+        wilton::support::log_info("wilton.engine.v8.init", std::string() + "Engine initialization complete," +
+                " snapshot: [" + sl::support::to_string_bool(nullptr != snapshot) + "]," +
+                " time (us): [" + sl::support::to_string(elapsed.count()) + "]");
+    }
+
+    // also cleans up partially initialized engine
+    void release() STATICLIB_NOEXCEPT {
+        if (nullptr != isolate) {
+            {
+                v8::Locker locker(isolate);
+                v8::Isolate::Scope isolate_scope(isolate);
+                v8_allocation_scope allocation_scope(allocations, isolate);
+                if (nullptr != profiler.get()) {
+                    profiler->close();
+                }
+                if (nullptr != heap_profiler.get()) {
+                    heap_profiler->close();
+                }
+                run_fun_global.Reset();
+                ctx_global.Reset();
+                gc.reset();
+                loop.reset();
+                calls.reset();
+                if (nullptr != external_buffers.get()) {
+                    external_buffers->free_all();
+                }
+                v8_channel_registry::shared().release_isolate(isolate);
+            }
+            isolate->Dispose();
+            platform->dispose_isolate(isolate);
+            this->isolate = nullptr;
+        }
+        if (nullptr != allocations) {
+            allocations->release();
+            this->allocations = nullptr;
+        }
+        if (nullptr != metrics.get()) {
+            v8_metrics_registry::shared().remove(metrics);
+        }
+        if (nullptr != profiler.get()) {
+            v8_cpu_profiler_registry::shared().remove(profiler);
+        }
+        if (nullptr != heap_profiler.get()) {
+            v8_heap_profiler_registry::shared().remove(heap_profiler);
+        }
     }
 
+public:
     support::buffer run_callback_script(v8_engine&, sl::io::span<const char> callback_script_json) {
-        wilton::support::log_debug("wilton.engine.v8.run",
-                "Running callback script: [" + std::string(callback_script_json.data(), callback_script_json.size()) + "] ...");
+        static debug_level logger("wilton.engine.v8.run");
+        bool debug = logger.is_enabled();
+        if (debug) {
+            wilton::support::log_debug("wilton.engine.v8.run",
+                    "Running callback script: [" + std::string(callback_script_json.data(), callback_script_json.size()) + "] ...");
+        }
+        v8::Locker locker(isolate);
+        v8::Isolate::Scope isolate_scope(isolate);
+        v8_allocation_scope allocation_scope(allocations, isolate);
+        auto start = std::chrono::steady_clock::now();
+        // age is counted from the first callback, spare engines may wait long before it
+        if (0 == calls_served) {
+            this->first_call = start;
+        }
+        calls_served += 1;
+        gc->callback_started();
+        profiler->apply_requests();
+        heap_profiler->apply_requests();
+        auto deferred = sl::support::defer([this, start] () STATICLIB_NOEXCEPT {
+            metrics->callbacks.record_since(start);
+            // stop requested during the callback includes it into the profile
+            profiler->apply_requests();
+            heap_profiler->apply_requests();
+            // compilation and GC finalization tasks posted by V8
+            platform->run_foreground_tasks(isolate);
+            update_heap();
+            gc->callback_finished();
+        });
+        // CPU budget does not grow while waiting for async calls,
+        // so the wait is limited by the wall time budget in both modes
+        loop->deadline = timeout_ms > 0 ? start + std::chrono::milliseconds(timeout_ms) :
+                std::chrono::steady_clock::time_point::max();
+        loop->queue->clear_interrupt();
+        auto queue = loop->queue;
+        // destroyed first, pending termination is cancelled before running platform tasks
+        v8_watchdog_scope watch(isolate, timeout_ms, timeout_cpu, [queue] {
+            queue->interrupt();
+        });
         v8::HandleScope handle_scope(isolate);
         auto ctx = v8::Local<v8::Context>::New(isolate, ctx_global);
         v8::Context::Scope ctx_scope(ctx);
-        // get function
-        auto global = ctx->Global();
-        auto name = string_to_jsval(isolate, "WILTON_run");
-        auto fun_maybe = global->Get(ctx, name);
-        if (fun_maybe.IsEmpty()) {
-            throw support::exception(TRACEMSG("Error accessing 'WILTON_run' function: undefined"));
-        }
-        auto fun_val = fun_maybe.ToLocalChecked();
-        if (!fun_val->IsFunction()) {
+        if (run_fun_global.IsEmpty()) {
             throw support::exception(TRACEMSG("Error accessing 'WILTON_run' function: not a function"));
         }
-        auto fun = v8::Local<v8::Function>::Cast(fun_val);
+        auto fun = v8::Local<v8::Function>::New(isolate, run_fun_global);
+        // settle async calls left from previous callbacks
+        if (!loop->pending.empty()) {
+            loop->run_completions(ctx, false);
+        }
         // run
         v8::TryCatch trycatch(isolate);
         v8::Local<v8::Value> args[1];
         args[0] = string_to_jsval(isolate, callback_script_json.data(), callback_script_json.size());
+        if (payload_objects) {
+            // bootstrap code receives parsed object instead of JSON string
+            auto parsed_maybe = v8::JSON::Parse(ctx, v8::Local<v8::String>::Cast(args[0]));
+            if (parsed_maybe.IsEmpty()) {
+                auto stack = format_stack_trace(ctx, trycatch);
+                throw support::exception(TRACEMSG(stack));
+            }
+            args[0] = parsed_maybe.ToLocalChecked();
+        }
         auto res_maybe = fun->Call(ctx, v8::Null(isolate), 1, args);
-        wilton::support::log_debug("wilton.engine.v8.run",
-                "Callback run complete, result: [" + sl::support::to_string_bool(!res_maybe.IsEmpty()) + "]");
+        if (debug) {
+            wilton::support::log_debug("wilton.engine.v8.run",
+                    "Callback run complete, result: [" + sl::support::to_string_bool(!res_maybe.IsEmpty()) + "]");
+        }
+        if (gc->check_heap_limit_reached()) {
+            throw support::exception(TRACEMSG("Heap limit reached, callback script execution terminated"));
+        }
+        if (watch.timed_out()) {
+            throw_timed_out();
+        }
         if (res_maybe.IsEmpty()) {
             auto stack = format_stack_trace(ctx, trycatch);
             throw support::exception(TRACEMSG(stack));
         }
         auto res = res_maybe.ToLocalChecked();
+        if (res->IsPromise()) {
+            try {
+                res = loop->await(ctx, v8::Local<v8::Promise>::Cast(res));
+            } catch (const std::exception&) {
+                if (watch.timed_out()) {
+                    throw_timed_out();
+                }
+                throw;
+            }
+        }
         if (res->IsString()) {
-            auto res_str = jsval_to_string(isolate, res);
-            return support::make_string_buffer(res_str);
+            return jsval_to_buffer(v8::Local<v8::String>::Cast(res));
+        }
+        if (payload_objects && res->IsObject()) {
+            auto json_maybe = v8::JSON::Stringify(ctx, res);
+            if (json_maybe.IsEmpty()) {
+                auto stack = format_stack_trace(ctx, trycatch);
+                throw support::exception(TRACEMSG(stack));
+            }
+            return jsval_to_buffer(json_maybe.ToLocalChecked());
         }
         return support::make_null_buffer();
     }
 
+private:
+    void throw_timed_out() {
+        throw support::exception(TRACEMSG("Callback script execution timed out," +
+                " budget (ms): [" + sl::support::to_string(timeout_ms) + "]," +
+                " CPU time: [" + sl::support::to_string_bool(timeout_cpu) + "]"));
+    }
+
+    void update_heap() {
+        metrics->update_heap(isolate);
+        metrics->heap_array_buffer_memory.store(allocations->live_bytes.load(std::memory_order_relaxed),
+                std::memory_order_relaxed);
+    }
+
+    // resolved once, 'WILTON_run' is defined by the bootstrap code
+    void resolve_run_function() {
+        v8::HandleScope handle_scope(isolate);
+        auto ctx = v8::Local<v8::Context>::New(isolate, ctx_global);
+        v8::Context::Scope ctx_scope(ctx);
+        auto name = v8::String::NewFromUtf8(isolate, "WILTON_run", v8::NewStringType::kInternalized);
+        if (name.IsEmpty()) {
+            return;
+        }
+        auto fun_maybe = ctx->Global()->Get(ctx, name.ToLocalChecked());
+        if (fun_maybe.IsEmpty()) {
+            return;
+        }
+        auto fun_val = fun_maybe.ToLocalChecked();
+        if (fun_val->IsFunction()) {
+            run_fun_global.Reset(isolate, v8::Local<v8::Function>::Cast(fun_val));
+        }
+    }
+
+public:
+    std::string recycle_reason(v8_engine&) {
+        if (recycle_calls > 0 && calls_served >= recycle_calls) {
+            return "calls";
+        }
+        if (recycle_old_space_bytes > 0 &&
+                metrics->heap_old_space_after_gc.load(std::memory_order_relaxed) >= recycle_old_space_bytes) {
+            return "old_space";
+        }
+        if (recycle_age.count() > 0 && calls_served > 0 &&
+                std::chrono::steady_clock::now() - first_call >= recycle_age) {
+            return "age";
+        }
+        return std::string();
+    }
+
     void run_garbage_collector(v8_engine&) {
-        isolate->IdleNotificationDeadline(1);
+        v8::Locker locker(isolate);
+        v8::Isolate::Scope isolate_scope(isolate);
+        v8_allocation_scope allocation_scope(allocations, isolate);
+        profiler->apply_requests();
+        heap_profiler->apply_requests();
+        platform->run_foreground_tasks(isolate);
+        gc->run_idle_gc();
     }
 
     static void initialize() {
-        auto cfg = get_config();
-        v8::Platform* platform = v8::platform::CreateDefaultPlatform(static_cast<int>(cfg.thread_pool_size));
+        auto cfg = v8_config::from_wilton_config();
+        v8_code_cache::shared().configure(cfg.code_cache, cfg.code_cache_dir);
+        v8_async_executor::shared(cfg.async_pool_size);
+        v8_cpu_profiler_registry::shared().configure(static_cast<int>(cfg.cpu_profile_interval_us),
+                cfg.cpu_profile_dir);
+        v8_heap_profiler_registry::shared().configure(cfg.heap_profile_dir);
+        v8_source_store::shared().configure(cfg.shared_sources);
+        if (cfg.callback_timeout_ms > 0) {
+            v8_watchdog::shared(cfg.watchdog_tick_ms);
+        }
+        configure_array_buffer_allocator(static_cast<uint64_t>(cfg.array_buffer_budget_mb) * 1024 * 1024,
+                static_cast<uint64_t>(cfg.array_buffer_pool_mb) * 1024 * 1024);
+        platform = std::addressof(v8_platform::shared(cfg.thread_pool_size, cfg.platform_affinity));
         v8::V8::InitializePlatform(platform);
+        v8_script_streamer::shared().configure(platform, static_cast<size_t>(cfg.streaming_min_size_kb) * 1024);
         v8::V8::InitializeICU();
         v8::V8::Initialize();
+        if (!cfg.preload_manifest.empty()) {
+            auto paths = v8_module_preloader::load_manifest(cfg.preload_manifest);
+            v8_module_preloader::shared().start(paths, cfg.async_pool_size, cfg.code_cache);
+        }
+    }
+
+    static sl::json::value code_cache_stats() {
+        return v8_code_cache::shared().stats();
+    }
+
+    static sl::json::value stats() {
+        auto res = v8_metrics_registry::shared().collect();
+        auto& fields = res.as_object_or_throw();
+        fields.emplace_back("code_cache", v8_code_cache::shared().stats());
+        fields.emplace_back("array_buffers", array_buffer_allocator_stats());
+        fields.emplace_back("preload", v8_module_preloader::shared().stats());
+        fields.emplace_back("sources", v8_source_store::shared().stats());
+        fields.emplace_back("platform", platform->stats());
+        // watchdog is created only when callback timeout is enabled
+        if (v8_watchdog::is_created()) {
+            fields.emplace_back("watchdog", v8_watchdog::shared().stats());
+        }
+        return res;
     }
 };
 
 PIMPL_FORWARD_CONSTRUCTOR(v8_engine, (sl::io::span<const char>), (), support::exception)
 PIMPL_FORWARD_METHOD(v8_engine, support::buffer, run_callback_script, (sl::io::span<const char>), (), support::exception)
+PIMPL_FORWARD_METHOD(v8_engine, std::string, recycle_reason, (), (), support::exception)
 PIMPL_FORWARD_METHOD(v8_engine, void, run_garbage_collector, (), (), support::exception)
 PIMPL_FORWARD_METHOD_STATIC(v8_engine, void, initialize, (), (), support::exception)
+PIMPL_FORWARD_METHOD_STATIC(v8_engine, sl::json::value, code_cache_stats, (), (), support::exception)
+PIMPL_FORWARD_METHOD_STATIC(v8_engine, sl::json::value, stats, (), (), support::exception)
 
 } // namespace
 }
@@ -54,9 +54,21 @@ public:
 
     support::buffer run_callback_script(sl::io::span<const char> callback_script_json);
 
+    /**
+     * Checks recycling limits from 'v8_config', must be called
+     * between callbacks from the thread that runs them
+     *
+     * @return name of the limit reached or empty string
+     */
+    std::string recycle_reason();
+
     void run_garbage_collector();
 
     static void initialize();
+
+    static sl::json::value code_cache_stats();
+
+    static sl::json::value stats();
 };
 
 } // namespace
@@ -0,0 +1,282 @@
+/*
+ * Copyright 2026, agent
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * File:   v8_engine_map.cpp
+ * Author: agent
+ */
+
+#include "v8_engine_map.hpp"
+
+#include <algorithm>
+#include <chrono>
+
+#include "staticlib/support.hpp"
+
+#include "wilton/support/exception.hpp"
+#include "wilton/support/logging.hpp"
+
+#include "v8_metrics.hpp"
+
+namespace wilton {
+namespace v8eng {
+
+namespace { // anonymous
+
+const std::chrono::seconds build_retry_delay{1};
+const uint32_t build_retry_backoff_max_shift = 6;
+const uint32_t build_failures_max = 10;
+
+sl::json::value json_u64(uint64_t num) {
+    return sl::json::value(static_cast<int64_t>(num));
+}
+
+// the same form is used by wilton for TLS cleanup
+std::string current_thread_id() {
+    return sl::support::to_string_any(std::this_thread::get_id());
+}
+
+} // namespace
+
+v8_engine_map::v8_engine_map(size_t spares_count) :
+spares_count(spares_count),
+adopted(0),
+waited(0),
+wait_us(0),
+built(0),
+failures(0),
+recycles(0) {
+    this->builder = std::thread(&v8_engine_map::run_builder, this);
+    wilton::support::log_info("wilton.engine.v8.spares", std::string() + "Engine map created," +
+            " spare engines: [" + sl::support::to_string(spares_count) + "]");
+}
+
+v8_engine_map::~v8_engine_map() STATICLIB_NOEXCEPT {
+    {
+        std::lock_guard<std::mutex> guard{mutex};
+        stopping = true;
+    }
+    cv.notify_all();
+    if (builder.joinable()) {
+        builder.join();
+    }
+}
+
+void v8_engine_map::set_init_code(std::shared_ptr<const std::string> code) {
+    {
+        std::lock_guard<std::mutex> guard{mutex};
+        if (nullptr != init_code.get()) {
+            return;
+        }
+        this->init_code = std::move(code);
+    }
+    cv.notify_all();
+}
+
+support::buffer v8_engine_map::run_script(sl::io::span<const char> callback_script_json) {
+    auto engine = thread_engine();
+    // checked between callbacks, engine is handed over to the builder for disposal
+    auto deferred = sl::support::defer([this, &engine] () STATICLIB_NOEXCEPT {
+        recycle_if_needed(engine);
+    });
+    return engine->run_callback_script(callback_script_json);
+}
+
+void v8_engine_map::run_garbage_collector() {
+    auto tid = current_thread_id();
+    auto engine = std::shared_ptr<v8_engine>();
+    {
+        std::lock_guard<std::mutex> guard{mutex};
+        auto it = engines.find(tid);
+        if (engines.end() != it) {
+            engine = it->second;
+        }
+    }
+    if (nullptr != engine.get()) {
+        engine->run_garbage_collector();
+    }
+}
+
+void v8_engine_map::clean_thread_local(const char* thread_id, int thread_id_len) {
+    auto tid = std::string(thread_id, static_cast<size_t>(thread_id_len));
+    auto engine = std::shared_ptr<v8_engine>();
+    {
+        std::lock_guard<std::mutex> guard{mutex};
+        auto it = engines.find(tid);
+        if (engines.end() != it) {
+            engine = std::move(it->second);
+            engines.erase(it);
+        }
+        recycled_threads.erase(tid);
+    }
+    // disposed outside of the lock
+    engine.reset();
+}
+
+sl::json::value v8_engine_map::stats() {
+    auto threads = size_t(0);
+    auto ready = size_t(0);
+    bool suspended = false;
+    {
+        std::lock_guard<std::mutex> guard{mutex};
+        threads = engines.size();
+        ready = spares.size();
+        suspended = building_suspended;
+    }
+    return {
+        { "size", static_cast<int64_t>(spares_count) },
+        { "ready", static_cast<int64_t>(ready) },
+        { "building_suspended", suspended },
+        { "threads", static_cast<int64_t>(threads) },
+        { "adopted", json_u64(adopted.load(std::memory_order_relaxed)) },
+        { "waited", json_u64(waited.load(std::memory_order_relaxed)) },
+        { "wait_us", json_u64(wait_us.load(std::memory_order_relaxed)) },
+        { "built", json_u64(built.load(std::memory_order_relaxed)) },
+        { "failures", json_u64(failures.load(std::memory_order_relaxed)) },
+        { "recycles", json_u64(recycles.load(std::memory_order_relaxed)) }
+    };
+}
+
+std::shared_ptr<v8_engine> v8_engine_map::thread_engine() {
+    auto tid = current_thread_id();
+    auto code = std::shared_ptr<const std::string>();
+    {
+        std::lock_guard<std::mutex> guard{mutex};
+        auto it = engines.find(tid);
+        if (engines.end() != it) {
+            return it->second;
+        }
+        recycled_threads.erase(tid);
+        if (!spares.empty()) {
+            auto engine = std::move(spares.front());
+            spares.pop_front();
+            engines.emplace(tid, engine);
+            adopted.fetch_add(1, std::memory_order_relaxed);
+            cv.notify_all();
+            return engine;
+        }
+        if (nullptr == init_code.get()) {
+            throw support::exception(TRACEMSG("Engine init code is not available"));
+        }
+        code = init_code;
+    }
+    // no spare engine is ready, construction is done on the request path
+    waited.fetch_add(1, std::memory_order_relaxed);
+    auto start = std::chrono::steady_clock::now();
+    auto span = sl::io::span<const char>(code->data(), code->length());
+    auto engine = std::make_shared<v8_engine>(span);
+    auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::steady_clock::now() - start);
+    wait_us.fetch_add(static_cast<uint64_t>(elapsed.count()), std::memory_order_relaxed);
+    std::lock_guard<std::mutex> guard{mutex};
+    engines.emplace(tid, engine);
+    if (building_suspended) {
+        wilton::support::log_info("wilton.engine.v8.spares", "Building of spare engines resumed");
+        this->building_suspended = false;
+        this->failures_in_row = 0;
+        cv.notify_all();
+    }
+    return engine;
+}
+
+void v8_engine_map::recycle_if_needed(std::shared_ptr<v8_engine>& engine) STATICLIB_NOEXCEPT {
+    try {
+        auto reason = engine->recycle_reason();
+        if (reason.empty()) {
+            return;
+        }
+        auto tid = current_thread_id();
+        wilton::support::log_info("wilton.engine.v8.recycle", std::string() + "Recycling engine," +
+                " thread: [" + tid + "], reason: [" + reason + "]");
+        recycles.fetch_add(1, std::memory_order_relaxed);
+        v8_metrics_registry::shared().recycled(reason);
+        {
+            std::lock_guard<std::mutex> guard{mutex};
+            auto it = engines.find(tid);
+            if (engines.end() != it && it->second == engine) {
+                engines.erase(it);
+            }
+            recycled_threads.insert(tid);
+            retired.emplace_back(std::move(engine));
+        }
+        cv.notify_all();
+    } catch (const std::exception& e) {
+        wilton::support::log_warn("wilton.engine.v8.recycle", TRACEMSG(e.what() +
+                "\nError recycling engine"));
+    }
+}
+
+bool v8_engine_map::builder_has_work() {
+    return stopping || !retired.empty() || (nullptr != init_code.get() && !building_suspended &&
+            spares.size() < spares_count + recycled_threads.size());
+}
+
+void v8_engine_map::run_builder() {
+    for (;;) {
+        auto engine_retired = std::shared_ptr<v8_engine>();
+        auto code = std::shared_ptr<const std::string>();
+        {
+            std::unique_lock<std::mutex> guard{mutex};
+            cv.wait(guard, [this] {
+                return builder_has_work();
+            });
+            if (stopping) {
+                return;
+            }
+            if (!retired.empty()) {
+                engine_retired = std::move(retired.front());
+                retired.pop_front();
+            }
+            code = init_code;
+        }
+        // disposal is done before building the replacement
+        if (nullptr != engine_retired.get()) {
+            engine_retired.reset();
+            continue;
+        }
+        try {
+            auto span = sl::io::span<const char>(code->data(), code->length());
+            auto engine = std::make_shared<v8_engine>(span);
+            built.fetch_add(1, std::memory_order_relaxed);
+            std::lock_guard<std::mutex> guard{mutex};
+            this->failures_in_row = 0;
+            if (!stopping) {
+                spares.emplace_back(std::move(engine));
+            }
+        } catch (const std::exception& e) {
+            failures.fetch_add(1, std::memory_order_relaxed);
+            wilton::support::log_warn("wilton.engine.v8.spares", TRACEMSG(e.what() +
+                    "\nError building spare engine"));
+            std::unique_lock<std::mutex> guard{mutex};
+            this->failures_in_row += 1;
+            if (failures_in_row >= build_failures_max) {
+                wilton::support::log_error("wilton.engine.v8.spares", std::string() +
+                        "Building of spare engines suspended," +
+                        " failures in a row: [" + sl::support::to_string(failures_in_row) + "]");
+                this->building_suspended = true;
+                continue;
+            }
+            // delay doubles with every failure in a row
+            auto shift = std::min(failures_in_row - 1, build_retry_backoff_max_shift);
+            cv.wait_for(guard, build_retry_delay * (1 << shift), [this] {
+                return stopping;
+            });
+        }
+    }
+}
+
+} // namespace
+}
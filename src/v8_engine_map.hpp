@@ -0,0 +1,118 @@
+/*
+ * Copyright 2026, agent
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * File:   v8_engine_map.hpp
+ * Author: agent
+ */
+
+#ifndef WILTON_V8_ENGINE_MAP_HPP
+#define WILTON_V8_ENGINE_MAP_HPP
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+
+#include "staticlib/io.hpp"
+#include "staticlib/json.hpp"
+
+#include "wilton/support/buffer.hpp"
+
+#include "v8_engine.hpp"
+
+namespace wilton {
+namespace v8eng {
+
+/**
+ * Thread-local engines, alternative to 'script_engine_map' that keeps
+ * a number of fully initialized spare engines built by a background
+ * thread, first call on a new thread adopts a spare engine instead
+ * of constructing it on the request path. Engines that reach recycling
+ * limits are disposed and replaced by the same background thread.
+ */
+class v8_engine_map {
+    size_t spares_count;
+
+    std::mutex mutex;
+    std::condition_variable cv;
+    // resolved by wilton core, spares are not built until it is available
+    std::shared_ptr<const std::string> init_code;
+    std::unordered_map<std::string, std::shared_ptr<v8_engine>> engines;
+    std::deque<std::shared_ptr<v8_engine>> spares;
+    std::deque<std::shared_ptr<v8_engine>> retired;
+    // threads waiting for the replacement of a recycled engine
+    std::unordered_set<std::string> recycled_threads;
+    // building is suspended after repeated failures until
+    // an engine is constructed on the request path
+    uint32_t failures_in_row = 0;
+    bool building_suspended = false;
+    bool stopping = false;
+    std::thread builder;
+
+    std::atomic<uint64_t> adopted;
+    std::atomic<uint64_t> waited;
+    std::atomic<uint64_t> wait_us;
+    std::atomic<uint64_t> built;
+    std::atomic<uint64_t> failures;
+    std::atomic<uint64_t> recycles;
+
+public:
+    explicit v8_engine_map(size_t spares_count);
+
+    ~v8_engine_map() STATICLIB_NOEXCEPT;
+
+    v8_engine_map(const v8_engine_map&) = delete;
+
+    v8_engine_map& operator=(const v8_engine_map&) = delete;
+
+    /**
+     * Sets init code for all engines, spares are built after it is set,
+     * only the first call has effect
+     *
+     * @param code init code resolved by wilton core
+     */
+    void set_init_code(std::shared_ptr<const std::string> code);
+
+    support::buffer run_script(sl::io::span<const char> callback_script_json);
+
+    void run_garbage_collector();
+
+    void clean_thread_local(const char* thread_id, int thread_id_len);
+
+    sl::json::value stats();
+
+private:
+    std::shared_ptr<v8_engine> thread_engine();
+
+    void recycle_if_needed(std::shared_ptr<v8_engine>& engine) STATICLIB_NOEXCEPT;
+
+    bool builder_has_work();
+
+    void run_builder();
+};
+
+} // namespace
+}
+
+#endif /* WILTON_V8_ENGINE_MAP_HPP */
+
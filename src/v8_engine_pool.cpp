@@ -0,0 +1,260 @@
+/*
+ * Copyright 2026, agent
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * File:   v8_engine_pool.cpp
+ * Author: agent
+ */
+
+#include "v8_engine_pool.hpp"
+
+#include <algorithm>
+
+#include "staticlib/support.hpp"
+
+#include "wilton/support/exception.hpp"
+#include "wilton/support/logging.hpp"
+
+#include "v8_metrics.hpp"
+
+namespace wilton {
+namespace v8eng {
+
+v8_engine_pool::v8_engine_pool(size_t max_size, uint32_t lease_timeout_ms) :
+max_size(max_size),
+lease_timeout(lease_timeout_ms),
+leases(0),
+waits(0),
+timeouts(0),
+replaced(0),
+failures(0) {
+    this->builder = std::thread(&v8_engine_pool::run_builder, this);
+    wilton::support::log_info("wilton.engine.v8.pool", std::string() + "Engine pool created," +
+            " size: [" + sl::support::to_string(max_size) + "]," +
+            " lease timeout (ms): [" + sl::support::to_string(lease_timeout_ms) + "]");
+}
+
+v8_engine_pool::~v8_engine_pool() STATICLIB_NOEXCEPT {
+    {
+        std::lock_guard<std::mutex> guard{mutex};
+        stopping = true;
+    }
+    cv.notify_all();
+    if (builder.joinable()) {
+        builder.join();
+    }
+}
+
+void v8_engine_pool::set_init_code(std::shared_ptr<const std::string> code) {
+    {
+        std::lock_guard<std::mutex> guard{mutex};
+        if (nullptr != init_code.get()) {
+            return;
+        }
+        this->init_code = std::move(code);
+    }
+    cv.notify_all();
+}
+
+support::buffer v8_engine_pool::run_script(sl::io::span<const char> callback_script_json) {
+    auto engine = lease();
+    auto deferred = sl::support::defer([this, engine] () STATICLIB_NOEXCEPT {
+        release(engine);
+    });
+    return engine->run_callback_script(callback_script_json);
+}
+
+void v8_engine_pool::run_garbage_collector() {
+    // idle engines are taken out of the pool for the duration of GC
+    auto engines = std::vector<std::shared_ptr<v8_engine>>();
+    {
+        std::lock_guard<std::mutex> guard{mutex};
+        engines.swap(idle);
+    }
+    for (auto& en : engines) {
+        try {
+            en->run_garbage_collector();
+        } catch (const std::exception& e) {
+            wilton::support::log_warn("wilton.engine.v8.pool", TRACEMSG(e.what() +
+                    "\nError running garbage collector on pooled engine"));
+        }
+    }
+    {
+        std::lock_guard<std::mutex> guard{mutex};
+        for (auto& en : engines) {
+            idle.emplace_back(std::move(en));
+        }
+    }
+    cv.notify_all();
+}
+
+sl::json::value v8_engine_pool::stats() {
+    std::lock_guard<std::mutex> guard{mutex};
+    return {
+        { "size", static_cast<int64_t>(max_size) },
+        { "created", static_cast<int64_t>(created) },
+        { "idle", static_cast<int64_t>(idle.size()) },
+        { "waiting", static_cast<int64_t>(waiters.size()) },
+        { "leases", static_cast<int64_t>(leases.load()) },
+        { "waits", static_cast<int64_t>(waits.load()) },
+        { "timeouts", static_cast<int64_t>(timeouts.load()) },
+        { "replacing", static_cast<int64_t>(replacements) },
+        { "replaced", static_cast<int64_t>(replaced.load()) },
+        { "failures", static_cast<int64_t>(failures.load()) }
+    };
+}
+
+std::shared_ptr<v8_engine> v8_engine_pool::lease() {
+    std::unique_lock<std::mutex> guard{mutex};
+    leases += 1;
+    auto id = next_waiter_id++;
+    waiters.push_back(id);
+    // only the head of the queue may take an engine, so leases are granted in arrival order
+    auto ready = [this, id] {
+        return waiters.front() == id && (!idle.empty() || created < max_size);
+    };
+    if (!ready()) {
+        waits += 1;
+        if (lease_timeout.count() > 0) {
+            if (!cv.wait_for(guard, lease_timeout, ready)) {
+                waiters.erase(std::find(waiters.begin(), waiters.end(), id));
+                timeouts += 1;
+                guard.unlock();
+                cv.notify_all();
+                throw support::exception(TRACEMSG("Engine pool lease timeout exceeded," +
+                        " timeout (ms): [" + sl::support::to_string(lease_timeout.count()) + "]"));
+            }
+        } else {
+            cv.wait(guard, ready);
+        }
+    }
+    waiters.pop_front();
+    if (!idle.empty()) {
+        auto engine = std::move(idle.back());
+        idle.pop_back();
+        guard.unlock();
+        cv.notify_all();
+        return engine;
+    }
+    created += 1;
+    auto code = init_code;
+    guard.unlock();
+    cv.notify_all();
+    try {
+        if (nullptr == code.get()) {
+            throw support::exception(TRACEMSG("Engine init code is not available"));
+        }
+        auto span = sl::io::span<const char>(code->data(), code->length());
+        return std::make_shared<v8_engine>(span);
+    } catch (...) {
+        {
+            std::lock_guard<std::mutex> guard_created{mutex};
+            created -= 1;
+        }
+        cv.notify_all();
+        throw;
+    }
+}
+
+void v8_engine_pool::release(std::shared_ptr<v8_engine> engine) {
+    if (recycle_if_needed(engine)) {
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> guard{mutex};
+        idle.emplace_back(std::move(engine));
+    }
+    cv.notify_all();
+}
+
+bool v8_engine_pool::recycle_if_needed(std::shared_ptr<v8_engine>& engine) STATICLIB_NOEXCEPT {
+    try {
+        auto reason = engine->recycle_reason();
+        if (reason.empty()) {
+            return false;
+        }
+        wilton::support::log_info("wilton.engine.v8.recycle", std::string() + "Recycling pooled engine," +
+                " reason: [" + reason + "]");
+        v8_metrics_registry::shared().recycled(reason);
+        {
+            // slot is kept for the replacement, both disposal
+            // and construction are done by the builder
+            std::lock_guard<std::mutex> guard{mutex};
+            retired.emplace_back(std::move(engine));
+            replacements += 1;
+        }
+        cv.notify_all();
+        return true;
+    } catch (const std::exception& e) {
+        wilton::support::log_warn("wilton.engine.v8.recycle", TRACEMSG(e.what() +
+                "\nError recycling pooled engine"));
+        return false;
+    }
+}
+
+bool v8_engine_pool::builder_has_work() {
+    return stopping || !retired.empty() || (replacements > 0 && nullptr != init_code.get());
+}
+
+void v8_engine_pool::run_builder() {
+    for (;;) {
+        auto engine_retired = std::shared_ptr<v8_engine>();
+        auto code = std::shared_ptr<const std::string>();
+        {
+            std::unique_lock<std::mutex> guard{mutex};
+            cv.wait(guard, [this] {
+                return builder_has_work();
+            });
+            if (stopping) {
+                return;
+            }
+            if (!retired.empty()) {
+                engine_retired = std::move(retired.front());
+                retired.pop_front();
+            }
+            code = init_code;
+        }
+        // disposal is done before building the replacement
+        if (nullptr != engine_retired.get()) {
+            engine_retired.reset();
+            continue;
+        }
+        auto engine = std::shared_ptr<v8_engine>();
+        try {
+            auto span = sl::io::span<const char>(code->data(), code->length());
+            engine = std::make_shared<v8_engine>(span);
+            replaced += 1;
+        } catch (const std::exception& e) {
+            failures += 1;
+            wilton::support::log_warn("wilton.engine.v8.pool", TRACEMSG(e.what() +
+                    "\nError building replacement engine, slot is released"));
+        }
+        {
+            std::lock_guard<std::mutex> guard{mutex};
+            replacements -= 1;
+            if (nullptr != engine.get()) {
+                idle.emplace_back(std::move(engine));
+            } else {
+                // next lease constructs the engine on the request path
+                created -= 1;
+            }
+        }
+        cv.notify_all();
+    }
+}
+
+} // namespace
+}
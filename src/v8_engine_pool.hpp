@@ -0,0 +1,114 @@
+/*
+ * Copyright 2026, agent
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * File:   v8_engine_pool.hpp
+ * Author: agent
+ */
+
+#ifndef WILTON_V8_ENGINE_POOL_HPP
+#define WILTON_V8_ENGINE_POOL_HPP
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "staticlib/io.hpp"
+#include "staticlib/json.hpp"
+
+#include "wilton/support/buffer.hpp"
+
+#include "v8_engine.hpp"
+
+namespace wilton {
+namespace v8eng {
+
+/**
+ * Bounded set of engines shared by all threads, alternative to
+ * the thread-local engines of 'script_engine_map'. Engines are created
+ * lazily and leased to callers in FIFO order. Engines that reach
+ * recycling limits are disposed and replaced by a background thread,
+ * the pool slot stays taken until the replacement is ready. Engines
+ * are bootstrapped from the init code resolved by wilton core.
+ */
+class v8_engine_pool {
+    std::mutex mutex;
+    std::condition_variable cv;
+    size_t max_size;
+    std::chrono::milliseconds lease_timeout;
+    std::shared_ptr<const std::string> init_code;
+    std::vector<std::shared_ptr<v8_engine>> idle;
+    size_t created = 0;
+    std::deque<uint64_t> waiters;
+    uint64_t next_waiter_id = 0;
+    std::deque<std::shared_ptr<v8_engine>> retired;
+    // slots of recycled engines waiting for the replacement
+    size_t replacements = 0;
+    bool stopping = false;
+    std::thread builder;
+
+    std::atomic<uint64_t> leases;
+    std::atomic<uint64_t> waits;
+    std::atomic<uint64_t> timeouts;
+    std::atomic<uint64_t> replaced;
+    std::atomic<uint64_t> failures;
+
+public:
+    v8_engine_pool(size_t max_size, uint32_t lease_timeout_ms);
+
+    ~v8_engine_pool() STATICLIB_NOEXCEPT;
+
+    v8_engine_pool(const v8_engine_pool&) = delete;
+
+    v8_engine_pool& operator=(const v8_engine_pool&) = delete;
+
+    /**
+     * Sets init code for all engines, only the first call has effect
+     *
+     * @param code init code resolved by wilton core
+     */
+    void set_init_code(std::shared_ptr<const std::string> code);
+
+    support::buffer run_script(sl::io::span<const char> callback_script_json);
+
+    void run_garbage_collector();
+
+    sl::json::value stats();
+
+private:
+    std::shared_ptr<v8_engine> lease();
+
+    void release(std::shared_ptr<v8_engine> engine);
+
+    bool recycle_if_needed(std::shared_ptr<v8_engine>& engine) STATICLIB_NOEXCEPT;
+
+    bool builder_has_work();
+
+    void run_builder();
+};
+
+} // namespace
+}
+
+#endif /* WILTON_V8_ENGINE_POOL_HPP */
+
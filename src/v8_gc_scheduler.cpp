@@ -0,0 +1,195 @@
+/*
+ * Copyright 2026, agent
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * File:   v8_gc_scheduler.cpp
+ * Author: agent
+ */
+
+#include "v8_gc_scheduler.hpp"
+
+#include <algorithm>
+#include <cstdio>
+
+#ifdef __linux__
+#include <unistd.h>
+#endif // __linux__
+
+#include "v8-platform.h"
+
+#include "staticlib/support.hpp"
+
+#include "wilton/support/logging.hpp"
+
+#include "v8_metrics.hpp"
+
+namespace wilton {
+namespace v8eng {
+
+namespace { // anonymous
+
+const uint64_t bytes_in_mb = 1024 * 1024;
+const double idle_estimate_weight = 0.25;
+// only a fraction of the expected idle period is given to GC
+const double idle_budget_fraction = 0.5;
+const double idle_budget_min_ms = 1;
+const std::chrono::milliseconds pressure_check_interval{500};
+
+uint64_t process_rss_bytes() {
+#ifdef __linux__
+    auto file = std::fopen("/proc/self/statm", "r");
+    if (nullptr == file) {
+        return 0;
+    }
+    unsigned long long size = 0;
+    unsigned long long resident = 0;
+    auto read = std::fscanf(file, "%llu %llu", std::addressof(size), std::addressof(resident));
+    std::fclose(file);
+    if (2 != read) {
+        return 0;
+    }
+    return static_cast<uint64_t>(resident) * static_cast<uint64_t>(sysconf(_SC_PAGESIZE));
+#else // !__linux__
+    return 0;
+#endif // __linux__
+}
+
+v8::MemoryPressureLevel pressure_level_for(uint64_t value, uint64_t threshold) {
+    if (0 == threshold || value <= threshold) {
+        return v8::MemoryPressureLevel::kNone;
+    }
+    if (value > threshold + threshold / 4) {
+        return v8::MemoryPressureLevel::kCritical;
+    }
+    return v8::MemoryPressureLevel::kModerate;
+}
+
+} // namespace
+
+v8_gc_scheduler::v8_gc_scheduler(v8::Isolate* isolate, v8_platform* platform, const v8_config& cfg) :
+isolate(isolate),
+platform(platform),
+idle_budget_max_ms(static_cast<double>(cfg.gc_idle_budget_max_ms)),
+rss_threshold_bytes(static_cast<uint64_t>(cfg.gc_rss_threshold_mb) * bytes_in_mb),
+heap_threshold_bytes(static_cast<uint64_t>(cfg.gc_heap_threshold_mb) * bytes_in_mb),
+heap_limit_extra_bytes(static_cast<size_t>(cfg.gc_heap_limit_extra_mb) * bytes_in_mb),
+last_pressure_check(std::chrono::steady_clock::now()) {
+    if (heap_limit_extra_bytes > 0) {
+        isolate->AddNearHeapLimitCallback(near_heap_limit, this);
+    }
+}
+
+v8_gc_scheduler::~v8_gc_scheduler() STATICLIB_NOEXCEPT {
+    if (heap_limit_extra_bytes > 0) {
+        isolate->RemoveNearHeapLimitCallback(near_heap_limit, 0);
+    }
+}
+
+void v8_gc_scheduler::callback_started() {
+    // limit reached by GC outside of a callback (platform or idle tasks) left
+    // the termination pending, it must not terminate this callback
+    if (check_heap_limit_reached()) {
+        wilton::support::log_warn("wilton.engine.v8.gc", "Heap limit was reached outside" +
+                std::string(" of a callback, pending termination cancelled"));
+    }
+    if (!callback_seen) {
+        return;
+    }
+    auto idle = std::chrono::steady_clock::now() - last_callback_end;
+    auto idle_ms = std::chrono::duration<double, std::milli>(idle).count();
+    idle_estimate_ms = idle_estimate_ms * (1 - idle_estimate_weight) + idle_ms * idle_estimate_weight;
+}
+
+void v8_gc_scheduler::callback_finished() {
+    check_memory_pressure();
+    if (idle_budget_max_ms > 0 && callback_seen) {
+        auto budget = std::min(idle_estimate_ms * idle_budget_fraction, idle_budget_max_ms);
+        if (budget >= idle_budget_min_ms) {
+            notify_idle(budget);
+        }
+    }
+    callback_seen = true;
+    last_callback_end = std::chrono::steady_clock::now();
+}
+
+void v8_gc_scheduler::run_idle_gc() {
+    // explicit requests are not limited by the measured idleness
+    notify_idle(std::max(idle_budget_max_ms, idle_budget_min_ms));
+}
+
+bool v8_gc_scheduler::check_heap_limit_reached() {
+    if (!heap_limit_reached) {
+        return false;
+    }
+    heap_limit_reached = false;
+    isolate->CancelTerminateExecution();
+    isolate->LowMemoryNotification();
+    // restores initial limit and registers the callback again
+    isolate->RemoveNearHeapLimitCallback(near_heap_limit, initial_heap_limit);
+    isolate->AddNearHeapLimitCallback(near_heap_limit, this);
+    return true;
+}
+
+void v8_gc_scheduler::notify_idle(double budget_ms) {
+    // deadline is an absolute platform time in seconds
+    auto deadline = platform->MonotonicallyIncreasingTime() + budget_ms / 1000;
+    platform->run_idle_tasks(isolate, deadline);
+    isolate->IdleNotificationDeadline(deadline);
+}
+
+void v8_gc_scheduler::check_memory_pressure() {
+    if (0 == rss_threshold_bytes && 0 == heap_threshold_bytes) {
+        return;
+    }
+    auto now = std::chrono::steady_clock::now();
+    if (now - last_pressure_check < pressure_check_interval) {
+        return;
+    }
+    last_pressure_check = now;
+    auto level = v8::MemoryPressureLevel::kNone;
+    if (rss_threshold_bytes > 0) {
+        level = std::max(level, pressure_level_for(process_rss_bytes(), rss_threshold_bytes));
+    }
+    if (heap_threshold_bytes > 0) {
+        auto heap = v8_metrics_registry::shared().total_heap_used();
+        level = std::max(level, pressure_level_for(heap, heap_threshold_bytes));
+    }
+    if (level != pressure_level) {
+        pressure_level = level;
+        wilton::support::log_debug("wilton.engine.v8.gc", "Memory pressure level changed," +
+                std::string(" level: [") + sl::support::to_string(static_cast<int>(level)) + "]");
+        isolate->MemoryPressureNotification(level);
+    }
+}
+
+size_t v8_gc_scheduler::near_heap_limit(void* data, size_t current_heap_limit, size_t initial_heap_limit) {
+    auto self = static_cast<v8_gc_scheduler*>(data);
+    if (self->heap_limit_reached) {
+        // already extended for the current callback
+        return current_heap_limit;
+    }
+    self->heap_limit_reached = true;
+    self->initial_heap_limit = initial_heap_limit;
+    wilton::support::log_warn("wilton.engine.v8.gc", std::string() + "Heap limit reached," +
+            " limit: [" + sl::support::to_string(current_heap_limit) + "]," +
+            " terminating current execution");
+    // extra space allows the terminated script to unwind
+    self->isolate->TerminateExecution();
+    return current_heap_limit + self->heap_limit_extra_bytes;
+}
+
+} // namespace
+}
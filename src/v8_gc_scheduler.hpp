@@ -0,0 +1,93 @@
+/*
+ * Copyright 2026, agent
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * File:   v8_gc_scheduler.hpp
+ * Author: agent
+ */
+
+#ifndef WILTON_V8_GC_SCHEDULER_HPP
+#define WILTON_V8_GC_SCHEDULER_HPP
+
+#include <chrono>
+#include <cstdint>
+
+#include "v8.h"
+
+#include "v8_config.hpp"
+#include "v8_platform.hpp"
+
+namespace wilton {
+namespace v8eng {
+
+/**
+ * Per-engine GC policy: idle-time notifications sized by measured
+ * idleness between callbacks, memory pressure notifications on
+ * process RSS and total heap thresholds, and graceful handling
+ * of the heap limit
+ */
+class v8_gc_scheduler {
+    v8::Isolate* isolate;
+    v8_platform* platform;
+    double idle_budget_max_ms;
+    uint64_t rss_threshold_bytes;
+    uint64_t heap_threshold_bytes;
+    size_t heap_limit_extra_bytes;
+
+    // accessed only from the owning thread, except the heap limit
+    // fields that are accessed from the GC callback
+    bool callback_seen = false;
+    std::chrono::steady_clock::time_point last_callback_end;
+    double idle_estimate_ms = 0;
+    std::chrono::steady_clock::time_point last_pressure_check;
+    v8::MemoryPressureLevel pressure_level = v8::MemoryPressureLevel::kNone;
+    bool heap_limit_reached = false;
+    size_t initial_heap_limit = 0;
+
+public:
+    v8_gc_scheduler(v8::Isolate* isolate, v8_platform* platform, const v8_config& cfg);
+
+    ~v8_gc_scheduler() STATICLIB_NOEXCEPT;
+
+    v8_gc_scheduler(const v8_gc_scheduler&) = delete;
+
+    v8_gc_scheduler& operator=(const v8_gc_scheduler&) = delete;
+
+    /**
+     * Must be called with the isolate locked before running the callback,
+     * heap limit state left from outside of the callbacks is reset
+     */
+    void callback_started();
+
+    void callback_finished();
+
+    void run_idle_gc();
+
+    bool check_heap_limit_reached();
+
+private:
+    void notify_idle(double budget_ms);
+
+    void check_memory_pressure();
+
+    static size_t near_heap_limit(void* data, size_t current_heap_limit, size_t initial_heap_limit);
+};
+
+} // namespace
+}
+
+#endif /* WILTON_V8_GC_SCHEDULER_HPP */
+
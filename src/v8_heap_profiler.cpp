@@ -0,0 +1,524 @@
+/*
+ * Copyright 2026, agent
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * File:   v8_heap_profiler.cpp
+ * Author: agent
+ */
+
+#include "v8_heap_profiler.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <map>
+
+#include "staticlib/support.hpp"
+
+#include "wilton/support/exception.hpp"
+#include "wilton/support/logging.hpp"
+#include "wilton/support/script_engine_map.hpp"
+
+#include "v8_cpu_profiler.hpp"
+
+namespace wilton {
+namespace v8eng {
+
+namespace { // anonymous
+
+const size_t default_top_functions = 10;
+
+// results of deferred requests kept for status
+const size_t completed_max_count = 64;
+
+sl::json::value json_u64(uint64_t num) {
+    return sl::json::value(static_cast<int64_t>(num));
+}
+
+std::string jsval_to_string(v8::Isolate* isolate, v8::Local<v8::Value> value) {
+    if (value.IsEmpty()) {
+        return std::string();
+    }
+    v8::String::Utf8Value utf8(isolate, value);
+    if (utf8.length() > 0) {
+        return std::string(*utf8, static_cast<size_t>(utf8.length()));
+    }
+    return std::string();
+}
+
+// snapshot is written by chunks as it is serialized
+class file_output_stream : public v8::OutputStream {
+    std::ofstream stream;
+    uint64_t written = 0;
+
+public:
+    explicit file_output_stream(const std::string& path) :
+    stream(path, std::ios::binary | std::ios::trunc) {
+        if (!stream.is_open()) {
+            throw support::exception(TRACEMSG("Error opening heap snapshot file, path: [" + path + "]"));
+        }
+    }
+
+    int GetChunkSize() override {
+        return 64 * 1024;
+    }
+
+    WriteResult WriteAsciiChunk(char* data, int size) override {
+        stream.write(data, size);
+        if (!stream.good()) {
+            return kAbort;
+        }
+        written += static_cast<uint64_t>(size);
+        return kContinue;
+    }
+
+    void EndOfStream() override {
+        stream.flush();
+    }
+
+    bool is_good() const {
+        return stream.good();
+    }
+
+    uint64_t bytes_written() const {
+        return written;
+    }
+};
+
+class site_stats {
+public:
+    uint64_t bytes = 0;
+    uint64_t count = 0;
+    std::map<std::string, std::pair<uint64_t, uint64_t>> functions;
+};
+
+std::vector<sl::json::value> aggregate_by_script(v8::Isolate* isolate, v8::AllocationProfile::Node* root,
+        size_t top_functions) {
+    auto scripts = std::map<std::string, site_stats>();
+    auto stack = std::vector<v8::AllocationProfile::Node*>();
+    stack.push_back(root);
+    while (!stack.empty()) {
+        auto node = stack.back();
+        stack.pop_back();
+        for (auto ch : node->children) {
+            stack.push_back(ch);
+        }
+        uint64_t bytes = 0;
+        uint64_t count = 0;
+        for (auto& al : node->allocations) {
+            bytes += static_cast<uint64_t>(al.size) * al.count;
+            count += al.count;
+        }
+        if (0 == count) {
+            continue;
+        }
+        auto script_name = jsval_to_string(isolate, node->script_name);
+        auto script = script_name.empty() ? std::string("(native)") :
+                support::script_engine_map_detail::shorten_script_path(script_name);
+        auto fun_name = jsval_to_string(isolate, node->name);
+        auto fun = (fun_name.empty() ? std::string("(anonymous)") : fun_name) + ":" +
+                sl::support::to_string(node->line_number);
+        auto& st = scripts[script];
+        st.bytes += bytes;
+        st.count += count;
+        auto& fst = st.functions[fun];
+        fst.first += bytes;
+        fst.second += count;
+    }
+    auto sorted = std::vector<std::pair<std::string, site_stats>>(scripts.begin(), scripts.end());
+    std::sort(sorted.begin(), sorted.end(), [](const std::pair<std::string, site_stats>& a,
+            const std::pair<std::string, site_stats>& b) {
+        return a.second.bytes > b.second.bytes;
+    });
+    auto res = std::vector<sl::json::value>();
+    for (auto& en : sorted) {
+        auto funs = std::vector<std::pair<std::string, std::pair<uint64_t, uint64_t>>>(
+                en.second.functions.begin(), en.second.functions.end());
+        std::sort(funs.begin(), funs.end(), [](const std::pair<std::string, std::pair<uint64_t, uint64_t>>& a,
+                const std::pair<std::string, std::pair<uint64_t, uint64_t>>& b) {
+            return a.second.first > b.second.first;
+        });
+        auto funs_json = std::vector<sl::json::value>();
+        for (size_t i = 0; i < funs.size() && i < top_functions; i++) {
+            funs_json.emplace_back(sl::json::value({
+                { "function", funs[i].first },
+                { "bytes", json_u64(funs[i].second.first) },
+                { "count", json_u64(funs[i].second.second) }
+            }));
+        }
+        res.emplace_back(sl::json::value({
+            { "script", en.first },
+            { "bytes", json_u64(en.second.bytes) },
+            { "count", json_u64(en.second.count) },
+            { "functions", std::move(funs_json) }
+        }));
+    }
+    return res;
+}
+
+} // namespace
+
+v8_heap_profiler::v8_heap_profiler(v8::Isolate* isolate, uint64_t engine_id) :
+isolate(isolate),
+engine_id(engine_id),
+requests_pending(false) { }
+
+uint64_t v8_heap_profiler::id() const {
+    return engine_id;
+}
+
+bool v8_heap_profiler::has_pending_requests() const {
+    return requests_pending.load(std::memory_order_relaxed);
+}
+
+sl::json::value v8_heap_profiler::request_snapshot(const std::string& dir) {
+    if (is_locked_by_current_thread()) {
+        return write_snapshot(dir);
+    }
+    std::lock_guard<std::mutex> guard{mutex};
+    if (closed) {
+        throw support::exception(TRACEMSG("Engine is disposed, id: [" + sl::support::to_string(engine_id) + "]"));
+    }
+    snapshot_requested = true;
+    snapshot_dir = dir;
+    requests_pending.store(true, std::memory_order_release);
+    return sl::json::value();
+}
+
+bool v8_heap_profiler::request_start_sampling(uint64_t interval_bytes, int stack_depth) {
+    if (is_locked_by_current_thread()) {
+        start_sampling(interval_bytes, stack_depth);
+        return true;
+    }
+    std::lock_guard<std::mutex> guard{mutex};
+    if (closed) {
+        return false;
+    }
+    start_requested = true;
+    stop_requested = false;
+    requested_interval_bytes = interval_bytes;
+    requested_stack_depth = stack_depth;
+    requests_pending.store(true, std::memory_order_release);
+    return false;
+}
+
+sl::json::value v8_heap_profiler::request_stop_sampling(size_t top_functions) {
+    if (is_locked_by_current_thread()) {
+        return stop_sampling(top_functions);
+    }
+    std::lock_guard<std::mutex> guard{mutex};
+    if (closed) {
+        return sl::json::value();
+    }
+    start_requested = false;
+    stop_requested = true;
+    requested_top_functions = top_functions;
+    requests_pending.store(true, std::memory_order_release);
+    return sl::json::value();
+}
+
+void v8_heap_profiler::apply_requests() STATICLIB_NOEXCEPT {
+    if (!requests_pending.load(std::memory_order_acquire)) {
+        return;
+    }
+    bool snapshot_req = false;
+    auto dir = std::string();
+    bool start_req = false;
+    uint64_t interval_bytes = 0;
+    int stack_depth = 0;
+    bool stop_req = false;
+    size_t top_functions = 0;
+    {
+        std::lock_guard<std::mutex> guard{mutex};
+        requests_pending.store(false, std::memory_order_relaxed);
+        if (closed) {
+            return;
+        }
+        snapshot_req = snapshot_requested;
+        dir = std::move(snapshot_dir);
+        start_req = start_requested;
+        interval_bytes = requested_interval_bytes;
+        stack_depth = requested_stack_depth;
+        stop_req = stop_requested;
+        top_functions = requested_top_functions;
+        snapshot_requested = false;
+        start_requested = false;
+        stop_requested = false;
+    }
+    auto& registry = v8_heap_profiler_registry::shared();
+    try {
+        if (stop_req) {
+            auto profile = stop_sampling(top_functions);
+            if (sl::json::type::nullt != profile.json_type()) {
+                registry.add_profile(std::move(profile));
+            }
+        }
+        if (start_req) {
+            start_sampling(interval_bytes, stack_depth);
+        }
+        if (snapshot_req) {
+            registry.add_snapshot(write_snapshot(dir));
+        }
+    } catch (const std::exception& e) {
+        wilton::support::log_error("wilton.engine.v8.profiler", TRACEMSG(e.what() +
+                "\nError applying heap profiler request, engine: [" + sl::support::to_string(engine_id) + "]"));
+    }
+}
+
+void v8_heap_profiler::close() STATICLIB_NOEXCEPT {
+    {
+        std::lock_guard<std::mutex> guard{mutex};
+        this->closed = true;
+        this->snapshot_requested = false;
+        this->start_requested = false;
+        this->stop_requested = false;
+        requests_pending.store(false, std::memory_order_relaxed);
+    }
+    if (sampling) {
+        v8::Isolate::Scope isolate_scope(isolate);
+        isolate->GetHeapProfiler()->StopSamplingHeapProfiler();
+        this->sampling = false;
+    }
+}
+
+bool v8_heap_profiler::is_locked_by_current_thread() {
+    // true only inside a callback of this engine
+    return v8::Locker::IsLocked(isolate);
+}
+
+sl::json::value v8_heap_profiler::write_snapshot(const std::string& dir) {
+    auto millis = std::chrono::duration_cast<std::chrono::milliseconds>(
+            std::chrono::system_clock::now().time_since_epoch()).count();
+    auto path = dir + "/v8-" + sl::support::to_string(engine_id) + "-" +
+            sl::support::to_string(millis) + ".heapsnapshot";
+    auto start = std::chrono::steady_clock::now();
+    v8::Isolate::Scope isolate_scope(isolate);
+    v8::HandleScope handle_scope(isolate);
+    auto hp = isolate->GetHeapProfiler();
+    auto snapshot = const_cast<v8::HeapSnapshot*>(hp->TakeHeapSnapshot());
+    if (nullptr == snapshot) {
+        throw support::exception(TRACEMSG("Error taking heap snapshot, engine: [" +
+                sl::support::to_string(engine_id) + "]"));
+    }
+    auto deferred = sl::support::defer([snapshot] () STATICLIB_NOEXCEPT {
+        snapshot->Delete();
+    });
+    file_output_stream stream(path);
+    snapshot->Serialize(std::addressof(stream), v8::HeapSnapshot::kJSON);
+    if (!stream.is_good()) {
+        std::remove(path.c_str());
+        throw support::exception(TRACEMSG("Error writing heap snapshot, path: [" + path + "]"));
+    }
+    auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(
+            std::chrono::steady_clock::now() - start);
+    wilton::support::log_info("wilton.engine.v8.profiler", std::string() + "Heap snapshot written," +
+            " engine: [" + sl::support::to_string(engine_id) + "]," +
+            " bytes: [" + sl::support::to_string(stream.bytes_written()) + "]," +
+            " time (ms): [" + sl::support::to_string(elapsed.count()) + "]," +
+            " path: [" + path + "]");
+    return {
+        { "engine", json_u64(engine_id) },
+        { "path", path },
+        { "bytes", json_u64(stream.bytes_written()) }
+    };
+}
+
+void v8_heap_profiler::start_sampling(uint64_t interval_bytes, int stack_depth) {
+    if (sampling) {
+        return;
+    }
+    v8::Isolate::Scope isolate_scope(isolate);
+    auto hp = isolate->GetHeapProfiler();
+    this->sampling = hp->StartSamplingHeapProfiler(interval_bytes, stack_depth);
+}
+
+sl::json::value v8_heap_profiler::stop_sampling(size_t top_functions) {
+    if (!sampling) {
+        return sl::json::value();
+    }
+    v8::Isolate::Scope isolate_scope(isolate);
+    v8::HandleScope handle_scope(isolate);
+    auto hp = isolate->GetHeapProfiler();
+    auto profile = std::unique_ptr<v8::AllocationProfile>(hp->GetAllocationProfile());
+    hp->StopSamplingHeapProfiler();
+    this->sampling = false;
+    if (nullptr == profile.get()) {
+        return sl::json::value();
+    }
+    auto scripts = aggregate_by_script(isolate, profile->GetRootNode(), top_functions);
+    return {
+        { "engine", json_u64(engine_id) },
+        { "scripts", std::move(scripts) }
+    };
+}
+
+void v8_heap_profiler_registry::configure(const std::string& default_dir) {
+    std::lock_guard<std::mutex> guard{mutex};
+    this->default_dir = default_dir;
+}
+
+void v8_heap_profiler_registry::add(std::shared_ptr<v8_heap_profiler> profiler) {
+    std::lock_guard<std::mutex> guard{mutex};
+    live.emplace_back(std::move(profiler));
+}
+
+void v8_heap_profiler_registry::remove(const std::shared_ptr<v8_heap_profiler>& profiler) {
+    std::lock_guard<std::mutex> guard{mutex};
+    auto it = std::find(live.begin(), live.end(), profiler);
+    if (live.end() != it) {
+        live.erase(it);
+    }
+}
+
+sl::json::value v8_heap_profiler_registry::write_snapshots(const sl::json::value& options) {
+    auto dir = std::string();
+    {
+        std::lock_guard<std::mutex> guard{mutex};
+        dir = default_dir;
+    }
+    auto& dir_json = options["directory"];
+    if (sl::json::type::nullt != dir_json.json_type()) {
+        dir = dir_json.as_string_nonempty_or_throw("directory");
+    }
+    auto res = std::vector<sl::json::value>();
+    auto pending = std::vector<sl::json::value>();
+    for (auto& pr : select(options)) {
+        auto snapshot_info = pr->request_snapshot(dir);
+        if (sl::json::type::nullt != snapshot_info.json_type()) {
+            res.emplace_back(std::move(snapshot_info));
+        } else {
+            pending.emplace_back(json_u64(pr->id()));
+        }
+    }
+    return {
+        { "snapshots", std::move(res) },
+        { "pending", std::move(pending) }
+    };
+}
+
+sl::json::value v8_heap_profiler_registry::start_sampling(const sl::json::value& options) {
+    uint64_t interval_bytes = 512 * 1024;
+    auto& interval_json = options["samplingIntervalBytes"];
+    if (sl::json::type::nullt != interval_json.json_type()) {
+        interval_bytes = interval_json.as_uint32_or_throw("samplingIntervalBytes");
+    }
+    int stack_depth = 16;
+    auto& depth_json = options["stackDepth"];
+    if (sl::json::type::nullt != depth_json.json_type()) {
+        stack_depth = static_cast<int>(depth_json.as_uint32_or_throw("stackDepth"));
+    }
+    if (0 == interval_bytes || 0 == stack_depth) {
+        throw support::exception(TRACEMSG("Invalid heap sampling options specified"));
+    }
+    auto ids = std::vector<sl::json::value>();
+    auto pending = std::vector<sl::json::value>();
+    for (auto& pr : select(options)) {
+        if (pr->request_start_sampling(interval_bytes, stack_depth)) {
+            ids.emplace_back(json_u64(pr->id()));
+        } else {
+            pending.emplace_back(json_u64(pr->id()));
+        }
+    }
+    return {
+        { "engines", std::move(ids) },
+        { "pending", std::move(pending) },
+        { "samplingIntervalBytes", json_u64(interval_bytes) },
+        { "stackDepth", stack_depth }
+    };
+}
+
+sl::json::value v8_heap_profiler_registry::stop_sampling(const sl::json::value& options) {
+    auto top = default_top_functions;
+    auto& top_json = options["topFunctions"];
+    if (sl::json::type::nullt != top_json.json_type()) {
+        top = static_cast<size_t>(top_json.as_uint32_or_throw("topFunctions"));
+    }
+    auto res = std::vector<sl::json::value>();
+    auto pending = std::vector<sl::json::value>();
+    for (auto& pr : select(options)) {
+        auto profile = pr->request_stop_sampling(top);
+        if (sl::json::type::nullt != profile.json_type()) {
+            res.emplace_back(std::move(profile));
+        } else {
+            pending.emplace_back(json_u64(pr->id()));
+        }
+    }
+    return {
+        { "profiles", std::move(res) },
+        { "pending", std::move(pending) }
+    };
+}
+
+sl::json::value v8_heap_profiler_registry::status() {
+    std::lock_guard<std::mutex> guard{mutex};
+    auto pending = std::vector<sl::json::value>();
+    for (auto& pr : live) {
+        if (pr->has_pending_requests()) {
+            pending.emplace_back(json_u64(pr->id()));
+        }
+    }
+    auto snapshots_json = std::vector<sl::json::value>();
+    for (auto& sn : snapshots) {
+        snapshots_json.emplace_back(sn.clone());
+    }
+    auto profiles_json = std::vector<sl::json::value>();
+    for (auto& pf : profiles) {
+        profiles_json.emplace_back(pf.clone());
+    }
+    return {
+        { "pending", std::move(pending) },
+        { "snapshots", std::move(snapshots_json) },
+        { "profiles", std::move(profiles_json) }
+    };
+}
+
+void v8_heap_profiler_registry::add_snapshot(sl::json::value snapshot_info) {
+    std::lock_guard<std::mutex> guard{mutex};
+    snapshots.emplace_back(std::move(snapshot_info));
+    if (snapshots.size() > completed_max_count) {
+        snapshots.pop_front();
+    }
+}
+
+void v8_heap_profiler_registry::add_profile(sl::json::value profile) {
+    std::lock_guard<std::mutex> guard{mutex};
+    profiles.emplace_back(std::move(profile));
+    if (profiles.size() > completed_max_count) {
+        profiles.pop_front();
+    }
+}
+
+v8_heap_profiler_registry& v8_heap_profiler_registry::shared() {
+    static v8_heap_profiler_registry registry;
+    return registry;
+}
+
+std::vector<std::shared_ptr<v8_heap_profiler>> v8_heap_profiler_registry::select(const sl::json::value& options) {
+    // engine ids and threads are tracked by the CPU profiler registry
+    auto ids = v8_cpu_profiler_registry::shared().select_ids(options);
+    std::lock_guard<std::mutex> guard{mutex};
+    auto res = std::vector<std::shared_ptr<v8_heap_profiler>>();
+    for (auto& pr : live) {
+        if (ids.end() != std::find(ids.begin(), ids.end(), pr->id())) {
+            res.push_back(pr);
+        }
+    }
+    return res;
+}
+
+} // namespace
+}
@@ -0,0 +1,175 @@
+/*
+ * Copyright 2026, agent
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * File:   v8_heap_profiler.hpp
+ * Author: agent
+ */
+
+#ifndef WILTON_V8_HEAP_PROFILER_HPP
+#define WILTON_V8_HEAP_PROFILER_HPP
+
+#include <atomic>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "v8.h"
+#include "v8-profiler.h"
+
+#include "staticlib/config.hpp"
+#include "staticlib/json.hpp"
+
+namespace wilton {
+namespace v8eng {
+
+/**
+ * Heap snapshots and sampling heap profiling for a single engine.
+ * Operations are done immediately when requested from a callback
+ * of the same engine, requests from other threads are recorded and
+ * applied by the engine around its next callback, so a foreign
+ * isolate is never locked from inside a callback.
+ */
+class v8_heap_profiler {
+    v8::Isolate* isolate;
+    uint64_t engine_id;
+
+    // guards requests
+    std::mutex mutex;
+    bool closed = false;
+    bool snapshot_requested = false;
+    std::string snapshot_dir;
+    bool start_requested = false;
+    uint64_t requested_interval_bytes = 0;
+    int requested_stack_depth = 0;
+    bool stop_requested = false;
+    size_t requested_top_functions = 0;
+    // checked before taking the mutex on every callback
+    std::atomic<bool> requests_pending;
+
+    // accessed only with the isolate locked
+    bool sampling = false;
+
+public:
+    v8_heap_profiler(v8::Isolate* isolate, uint64_t engine_id);
+
+    v8_heap_profiler(const v8_heap_profiler&) = delete;
+
+    v8_heap_profiler& operator=(const v8_heap_profiler&) = delete;
+
+    uint64_t id() const;
+
+    bool has_pending_requests() const;
+
+    /**
+     * Writes '.heapsnapshot' file streaming it directly to disk
+     *
+     * @param dir destination directory
+     * @return description of the written file or null if the request
+     *         is applied later, written files are reported by the registry
+     */
+    sl::json::value request_snapshot(const std::string& dir);
+
+    /**
+     * Starts sampling heap profiler
+     *
+     * @param interval_bytes average sampling interval
+     * @param stack_depth max stack depth of samples
+     * @return whether sampling is started now or the request is applied later
+     */
+    bool request_start_sampling(uint64_t interval_bytes, int stack_depth);
+
+    /**
+     * Stops sampling heap profiler
+     *
+     * @param top_functions max number of functions reported for each script
+     * @return live sampled allocations aggregated by script or null if the
+     *         request is applied later, profiles are reported by the registry
+     */
+    sl::json::value request_stop_sampling(size_t top_functions);
+
+    /**
+     * Applies pending requests, must be called with the isolate locked
+     * on the thread that runs callbacks, does not lock when there
+     * are no requests
+     */
+    void apply_requests() STATICLIB_NOEXCEPT;
+
+    /**
+     * Stops sampling and forbids further operations, must be called
+     * with the isolate locked before the isolate is disposed
+     */
+    void close() STATICLIB_NOEXCEPT;
+
+private:
+    bool is_locked_by_current_thread();
+
+    sl::json::value write_snapshot(const std::string& dir);
+
+    void start_sampling(uint64_t interval_bytes, int stack_depth);
+
+    sl::json::value stop_sampling(size_t top_functions);
+};
+
+/**
+ * Process-wide registry of engine heap profilers used by the control wiltoncalls,
+ * engines are selected the same way as for CPU profiling
+ */
+class v8_heap_profiler_registry {
+    std::mutex mutex;
+    std::vector<std::shared_ptr<v8_heap_profiler>> live;
+    // results of the requests applied by engines later
+    std::deque<sl::json::value> snapshots;
+    std::deque<sl::json::value> profiles;
+    std::string default_dir = ".";
+
+public:
+    void configure(const std::string& default_dir);
+
+    void add(std::shared_ptr<v8_heap_profiler> profiler);
+
+    void remove(const std::shared_ptr<v8_heap_profiler>& profiler);
+
+    sl::json::value write_snapshots(const sl::json::value& options);
+
+    sl::json::value start_sampling(const sl::json::value& options);
+
+    sl::json::value stop_sampling(const sl::json::value& options);
+
+    /**
+     * @return engines with pending requests and results of the requests
+     *         applied around engine callbacks
+     */
+    sl::json::value status();
+
+    void add_snapshot(sl::json::value snapshot_info);
+
+    void add_profile(sl::json::value profile);
+
+    static v8_heap_profiler_registry& shared();
+
+private:
+    std::vector<std::shared_ptr<v8_heap_profiler>> select(const sl::json::value& options);
+};
+
+} // namespace
+}
+
+#endif /* WILTON_V8_HEAP_PROFILER_HPP */
+
@@ -0,0 +1,359 @@
+/*
+ * Copyright 2026, agent
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * File:   v8_metrics.cpp
+ * Author: agent
+ */
+
+#include "v8_metrics.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+namespace wilton {
+namespace v8eng {
+
+namespace { // anonymous
+
+const uint32_t metrics_isolate_slot = 0;
+
+size_t bucket_index(uint64_t micros) {
+    size_t idx = 0;
+    while (micros > 0 && idx < latency_buckets_count - 1) {
+        micros >>= 1;
+        idx += 1;
+    }
+    return idx;
+}
+
+sl::json::value json_u64(uint64_t num) {
+    return sl::json::value(static_cast<int64_t>(num));
+}
+
+} // namespace
+
+latency_data::latency_data() {
+    buckets.fill(0);
+}
+
+void latency_data::add(const latency_data& other) {
+    for (size_t i = 0; i < latency_buckets_count; i++) {
+        buckets[i] += other.buckets[i];
+    }
+    count += other.count;
+    total_us += other.total_us;
+    max_us = std::max(max_us, other.max_us);
+}
+
+sl::json::value latency_data::to_json() const {
+    auto buckets_json = std::vector<sl::json::value>();
+    for (size_t i = 0; i < latency_buckets_count; i++) {
+        buckets_json.emplace_back(json_u64(buckets[i]));
+    }
+    return {
+        { "count", json_u64(count) },
+        { "total_us", json_u64(total_us) },
+        { "max_us", json_u64(max_us) },
+        { "mean_us", json_u64(count > 0 ? total_us / count : 0) },
+        { "p50_us", json_u64(percentile(0.5)) },
+        { "p90_us", json_u64(percentile(0.9)) },
+        { "p99_us", json_u64(percentile(0.99)) },
+        { "buckets", std::move(buckets_json) }
+    };
+}
+
+// upper bound of the bucket that contains the specified fraction of samples
+uint64_t latency_data::percentile(double fraction) const {
+    if (0 == count) {
+        return 0;
+    }
+    auto target = static_cast<uint64_t>(static_cast<double>(count) * fraction);
+    uint64_t seen = 0;
+    for (size_t i = 0; i < latency_buckets_count; i++) {
+        seen += buckets[i];
+        if (seen > target) {
+            return std::min(static_cast<uint64_t>(1) << i, max_us);
+        }
+    }
+    return max_us;
+}
+
+latency_histogram::latency_histogram() :
+count(0),
+total_us(0),
+max_us(0) {
+    for (auto& bu : buckets) {
+        bu.store(0, std::memory_order_relaxed);
+    }
+}
+
+void latency_histogram::record(uint64_t micros) {
+    buckets[bucket_index(micros)].fetch_add(1, std::memory_order_relaxed);
+    count.fetch_add(1, std::memory_order_relaxed);
+    total_us.fetch_add(micros, std::memory_order_relaxed);
+    auto prev = max_us.load(std::memory_order_relaxed);
+    while (micros > prev && !max_us.compare_exchange_weak(prev, micros, std::memory_order_relaxed));
+}
+
+void latency_histogram::record_since(std::chrono::steady_clock::time_point start) {
+    auto elapsed = std::chrono::steady_clock::now() - start;
+    record(static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(elapsed).count()));
+}
+
+void latency_histogram::add_to(latency_data& data) const {
+    auto snap = latency_data();
+    for (size_t i = 0; i < latency_buckets_count; i++) {
+        snap.buckets[i] = buckets[i].load(std::memory_order_relaxed);
+    }
+    snap.count = count.load(std::memory_order_relaxed);
+    snap.total_us = total_us.load(std::memory_order_relaxed);
+    snap.max_us = max_us.load(std::memory_order_relaxed);
+    data.add(snap);
+}
+
+void metrics_data::add(const metrics_data& other) {
+    engines += other.engines;
+    init.add(other.init);
+    callbacks.add(other.callbacks);
+    eval_compile.add(other.eval_compile);
+    eval_run.add(other.eval_run);
+    eval_stream.add(other.eval_stream);
+    stream_bytes += other.stream_bytes;
+    stream_offloaded_us += other.stream_offloaded_us;
+    load_count += other.load_count;
+    load_bytes += other.load_bytes;
+    for (auto& en : other.wiltoncalls) {
+        wiltoncalls[en.first].add(en.second);
+    }
+    gc_scavenge.add(other.gc_scavenge);
+    gc_mark_sweep.add(other.gc_mark_sweep);
+    gc_other.add(other.gc_other);
+    heap_total_size += other.heap_total_size;
+    heap_used_size += other.heap_used_size;
+    heap_size_limit += other.heap_size_limit;
+    heap_physical_size += other.heap_physical_size;
+    heap_malloced_memory += other.heap_malloced_memory;
+    heap_array_buffer_memory += other.heap_array_buffer_memory;
+    heap_old_space_after_gc += other.heap_old_space_after_gc;
+}
+
+sl::json::value metrics_data::to_json() const {
+    auto calls = std::vector<sl::json::field>();
+    for (auto& en : wiltoncalls) {
+        calls.emplace_back(en.first, en.second.to_json());
+    }
+    return {
+        { "engines", json_u64(engines) },
+        { "init", init.to_json() },
+        { "callbacks", callbacks.to_json() },
+        { "eval", {
+            { "compile", eval_compile.to_json() },
+            { "run", eval_run.to_json() },
+            { "stream", eval_stream.to_json() },
+            { "stream_bytes", json_u64(stream_bytes) },
+            { "stream_offloaded_us", json_u64(stream_offloaded_us) }
+        }},
+        { "load", {
+            { "count", json_u64(load_count) },
+            { "bytes", json_u64(load_bytes) }
+        }},
+        { "wiltoncalls", std::move(calls) },
+        { "gc", {
+            { "scavenge", gc_scavenge.to_json() },
+            { "mark_sweep", gc_mark_sweep.to_json() },
+            { "other", gc_other.to_json() }
+        }},
+        { "heap", {
+            { "total_heap_size", json_u64(heap_total_size) },
+            { "used_heap_size", json_u64(heap_used_size) },
+            { "heap_size_limit", json_u64(heap_size_limit) },
+            { "total_physical_size", json_u64(heap_physical_size) },
+            { "malloced_memory", json_u64(heap_malloced_memory) },
+            { "array_buffer_memory", json_u64(heap_array_buffer_memory) },
+            { "old_space_after_gc", json_u64(heap_old_space_after_gc) }
+        }}
+    };
+}
+
+v8_metrics::v8_metrics() :
+stream_bytes(0),
+stream_offloaded_us(0),
+load_count(0),
+load_bytes(0),
+heap_total_size(0),
+heap_used_size(0),
+heap_size_limit(0),
+heap_physical_size(0),
+heap_malloced_memory(0),
+heap_array_buffer_memory(0),
+heap_old_space_after_gc(0) { }
+
+latency_histogram& v8_metrics::wiltoncall(const std::string& name) {
+    // concurrent readers from 'add_to' do not modify the map
+    auto it = wiltoncalls.find(name);
+    if (wiltoncalls.end() != it) {
+        return *it->second;
+    }
+    // names come from scripts, so the map is bounded
+    if (wiltoncalls.size() >= wiltoncalls_max_count) {
+        return wiltoncalls_other;
+    }
+    auto hist = std::unique_ptr<latency_histogram>(new latency_histogram());
+    auto& res = *hist;
+    std::lock_guard<std::mutex> guard{wiltoncalls_mutex};
+    wiltoncalls.insert(std::make_pair(name, std::move(hist)));
+    return res;
+}
+
+void v8_metrics::update_heap(v8::Isolate* isolate) {
+    v8::HeapStatistics hs;
+    isolate->GetHeapStatistics(std::addressof(hs));
+    heap_total_size.store(hs.total_heap_size(), std::memory_order_relaxed);
+    heap_used_size.store(hs.used_heap_size(), std::memory_order_relaxed);
+    heap_size_limit.store(hs.heap_size_limit(), std::memory_order_relaxed);
+    heap_physical_size.store(hs.total_physical_size(), std::memory_order_relaxed);
+    heap_malloced_memory.store(hs.malloced_memory(), std::memory_order_relaxed);
+}
+
+void v8_metrics::gc_started() {
+    gc_start = std::chrono::steady_clock::now();
+}
+
+void v8_metrics::gc_finished(v8::Isolate* isolate, v8::GCType type) {
+    switch (type) {
+    case v8::kGCTypeScavenge:
+        gc_scavenge.record_since(gc_start);
+        break;
+    case v8::kGCTypeMarkSweepCompact:
+        gc_mark_sweep.record_since(gc_start);
+        for (size_t i = 0; i < isolate->NumberOfHeapSpaces(); i++) {
+            v8::HeapSpaceStatistics hss;
+            if (isolate->GetHeapSpaceStatistics(std::addressof(hss), i) &&
+                    0 == std::strcmp("old_space", hss.space_name())) {
+                heap_old_space_after_gc.store(hss.space_used_size(), std::memory_order_relaxed);
+            }
+        }
+        break;
+    default:
+        gc_other.record_since(gc_start);
+    }
+}
+
+void v8_metrics::add_to(metrics_data& data) const {
+    auto snap = metrics_data();
+    snap.engines = 1;
+    init.add_to(snap.init);
+    callbacks.add_to(snap.callbacks);
+    eval_compile.add_to(snap.eval_compile);
+    eval_run.add_to(snap.eval_run);
+    eval_stream.add_to(snap.eval_stream);
+    snap.stream_bytes = stream_bytes.load(std::memory_order_relaxed);
+    snap.stream_offloaded_us = stream_offloaded_us.load(std::memory_order_relaxed);
+    snap.load_count = load_count.load(std::memory_order_relaxed);
+    snap.load_bytes = load_bytes.load(std::memory_order_relaxed);
+    {
+        std::lock_guard<std::mutex> guard{wiltoncalls_mutex};
+        for (auto& en : wiltoncalls) {
+            en.second->add_to(snap.wiltoncalls[en.first]);
+        }
+        if (wiltoncalls.size() >= wiltoncalls_max_count) {
+            wiltoncalls_other.add_to(snap.wiltoncalls["(other)"]);
+        }
+    }
+    gc_scavenge.add_to(snap.gc_scavenge);
+    gc_mark_sweep.add_to(snap.gc_mark_sweep);
+    gc_other.add_to(snap.gc_other);
+    snap.heap_total_size = heap_total_size.load(std::memory_order_relaxed);
+    snap.heap_used_size = heap_used_size.load(std::memory_order_relaxed);
+    snap.heap_size_limit = heap_size_limit.load(std::memory_order_relaxed);
+    snap.heap_physical_size = heap_physical_size.load(std::memory_order_relaxed);
+    snap.heap_malloced_memory = heap_malloced_memory.load(std::memory_order_relaxed);
+    snap.heap_array_buffer_memory = heap_array_buffer_memory.load(std::memory_order_relaxed);
+    snap.heap_old_space_after_gc = heap_old_space_after_gc.load(std::memory_order_relaxed);
+    data.add(snap);
+}
+
+v8_metrics* v8_metrics::of_isolate(v8::Isolate* isolate) {
+    return static_cast<v8_metrics*>(isolate->GetData(metrics_isolate_slot));
+}
+
+void v8_metrics::attach_to_isolate(v8::Isolate* isolate, v8_metrics* metrics) {
+    isolate->SetData(metrics_isolate_slot, metrics);
+}
+
+void v8_metrics_registry::add(std::shared_ptr<v8_metrics> metrics) {
+    std::lock_guard<std::mutex> guard{mutex};
+    live.emplace_back(std::move(metrics));
+}
+
+void v8_metrics_registry::remove(const std::shared_ptr<v8_metrics>& metrics) {
+    std::lock_guard<std::mutex> guard{mutex};
+    auto it = std::find(live.begin(), live.end(), metrics);
+    if (live.end() != it) {
+        auto snap = metrics_data();
+        (*it)->add_to(snap);
+        // heap figures are meaningful only for live engines
+        snap.engines = 0;
+        snap.heap_total_size = 0;
+        snap.heap_used_size = 0;
+        snap.heap_size_limit = 0;
+        snap.heap_physical_size = 0;
+        snap.heap_malloced_memory = 0;
+        snap.heap_array_buffer_memory = 0;
+        snap.heap_old_space_after_gc = 0;
+        retired.add(snap);
+        live.erase(it);
+    }
+}
+
+sl::json::value v8_metrics_registry::collect() {
+    std::lock_guard<std::mutex> guard{mutex};
+    auto data = metrics_data();
+    data.add(retired);
+    for (auto& me : live) {
+        me->add_to(data);
+    }
+    auto res = data.to_json();
+    auto reasons = std::vector<sl::json::field>();
+    for (auto& en : recycles) {
+        reasons.emplace_back(en.first, json_u64(en.second));
+    }
+    res.as_object_or_throw().emplace_back("recycled", std::move(reasons));
+    return res;
+}
+
+uint64_t v8_metrics_registry::total_heap_used() {
+    std::lock_guard<std::mutex> guard{mutex};
+    uint64_t res = 0;
+    for (auto& me : live) {
+        res += me->heap_used_size.load(std::memory_order_relaxed);
+    }
+    return res;
+}
+
+void v8_metrics_registry::recycled(const std::string& reason) {
+    std::lock_guard<std::mutex> guard{mutex};
+    recycles[reason] += 1;
+}
+
+v8_metrics_registry& v8_metrics_registry::shared() {
+    static v8_metrics_registry registry;
+    return registry;
+}
+
+} // namespace
+}
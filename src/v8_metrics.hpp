@@ -0,0 +1,222 @@
+/*
+ * Copyright 2026, agent
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * File:   v8_metrics.hpp
+ * Author: agent
+ */
+
+#ifndef WILTON_V8_METRICS_HPP
+#define WILTON_V8_METRICS_HPP
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "v8.h"
+
+#include "staticlib/json.hpp"
+
+namespace wilton {
+namespace v8eng {
+
+const size_t latency_buckets_count = 32;
+
+// distinct wiltoncall names tracked per isolate
+const size_t wiltoncalls_max_count = 256;
+
+/**
+ * Plain copy of the histogram, used for aggregation
+ */
+class latency_data {
+public:
+    std::array<uint64_t, latency_buckets_count> buckets;
+    uint64_t count = 0;
+    uint64_t total_us = 0;
+    uint64_t max_us = 0;
+
+    latency_data();
+
+    void add(const latency_data& other);
+
+    sl::json::value to_json() const;
+
+private:
+    uint64_t percentile(double fraction) const;
+};
+
+/**
+ * Lock-free latency histogram with power-of-two microsecond buckets
+ */
+class latency_histogram {
+    std::array<std::atomic<uint64_t>, latency_buckets_count> buckets;
+    std::atomic<uint64_t> count;
+    std::atomic<uint64_t> total_us;
+    std::atomic<uint64_t> max_us;
+
+public:
+    latency_histogram();
+
+    latency_histogram(const latency_histogram&) = delete;
+
+    latency_histogram& operator=(const latency_histogram&) = delete;
+
+    void record(uint64_t micros);
+
+    void record_since(std::chrono::steady_clock::time_point start);
+
+    void add_to(latency_data& data) const;
+};
+
+/**
+ * Aggregated metrics of one or more engines
+ */
+class metrics_data {
+public:
+    uint64_t engines = 0;
+    latency_data init;
+    latency_data callbacks;
+    latency_data eval_compile;
+    latency_data eval_run;
+    latency_data eval_stream;
+    uint64_t stream_bytes = 0;
+    uint64_t stream_offloaded_us = 0;
+    uint64_t load_count = 0;
+    uint64_t load_bytes = 0;
+    std::map<std::string, latency_data> wiltoncalls;
+    latency_data gc_scavenge;
+    latency_data gc_mark_sweep;
+    latency_data gc_other;
+    uint64_t heap_total_size = 0;
+    uint64_t heap_used_size = 0;
+    uint64_t heap_size_limit = 0;
+    uint64_t heap_physical_size = 0;
+    uint64_t heap_malloced_memory = 0;
+    uint64_t heap_array_buffer_memory = 0;
+    uint64_t heap_old_space_after_gc = 0;
+
+    void add(const metrics_data& other);
+
+    sl::json::value to_json() const;
+};
+
+/**
+ * Per-engine counters, written by the owning thread and
+ * read concurrently by the aggregating thread
+ */
+class v8_metrics {
+public:
+    // isolate construction and bootstrap
+    latency_histogram init;
+    latency_histogram callbacks;
+    latency_histogram eval_compile;
+    latency_histogram eval_run;
+    // parsing done on platform workers, 'eval_compile' includes only
+    // the time the calling thread spent, waiting for the parse included
+    latency_histogram eval_stream;
+    std::atomic<uint64_t> stream_bytes;
+    // parse time that did not block the calling thread
+    std::atomic<uint64_t> stream_offloaded_us;
+    std::atomic<uint64_t> load_count;
+    std::atomic<uint64_t> load_bytes;
+    latency_histogram gc_scavenge;
+    latency_histogram gc_mark_sweep;
+    latency_histogram gc_other;
+    std::atomic<uint64_t> heap_total_size;
+    std::atomic<uint64_t> heap_used_size;
+    std::atomic<uint64_t> heap_size_limit;
+    std::atomic<uint64_t> heap_physical_size;
+    std::atomic<uint64_t> heap_malloced_memory;
+    std::atomic<uint64_t> heap_array_buffer_memory;
+    // old space used after the last full GC
+    std::atomic<uint64_t> heap_old_space_after_gc;
+
+private:
+    // modified only by the owning engine under the isolate lock, that engine
+    // looks up without locking, the mutex orders its inserts with other readers
+    mutable std::mutex wiltoncalls_mutex;
+    std::unordered_map<std::string, std::unique_ptr<latency_histogram>> wiltoncalls;
+    // calls with names beyond the limit of the map
+    latency_histogram wiltoncalls_other;
+    // accessed only from the owning thread
+    std::chrono::steady_clock::time_point gc_start;
+
+public:
+    v8_metrics();
+
+    v8_metrics(const v8_metrics&) = delete;
+
+    v8_metrics& operator=(const v8_metrics&) = delete;
+
+    /**
+     * Returns histogram for the specified call name, histograms are
+     * never removed, so callers may keep the returned reference,
+     * names beyond the limit share the '(other)' histogram
+     *
+     * @param name wiltoncall name
+     * @return histogram, must be called under the isolate lock
+     */
+    latency_histogram& wiltoncall(const std::string& name);
+
+    void update_heap(v8::Isolate* isolate);
+
+    void gc_started();
+
+    void gc_finished(v8::Isolate* isolate, v8::GCType type);
+
+    void add_to(metrics_data& data) const;
+
+    static v8_metrics* of_isolate(v8::Isolate* isolate);
+
+    static void attach_to_isolate(v8::Isolate* isolate, v8_metrics* metrics);
+};
+
+/**
+ * Process-wide registry of engine metrics, metrics of disposed
+ * engines are retained in totals
+ */
+class v8_metrics_registry {
+    std::mutex mutex;
+    std::vector<std::shared_ptr<v8_metrics>> live;
+    metrics_data retired;
+    std::map<std::string, uint64_t> recycles;
+
+public:
+    void add(std::shared_ptr<v8_metrics> metrics);
+
+    void remove(const std::shared_ptr<v8_metrics>& metrics);
+
+    sl::json::value collect();
+
+    uint64_t total_heap_used();
+
+    void recycled(const std::string& reason);
+
+    static v8_metrics_registry& shared();
+};
+
+} // namespace
+}
+
+#endif /* WILTON_V8_METRICS_HPP */
+
@@ -0,0 +1,264 @@
+/*
+ * Copyright 2026, agent
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * File:   v8_module_preloader.cpp
+ * Author: agent
+ */
+
+#include "v8_module_preloader.hpp"
+
+#include <algorithm>
+#include <chrono>
+
+#include "v8.h"
+
+#include "staticlib/support.hpp"
+
+#include "wilton/wilton.h"
+#include "wilton/wilton_loader.h"
+
+#include "wilton/support/exception.hpp"
+#include "wilton/support/logging.hpp"
+#include "wilton/support/script_engine_map.hpp"
+
+#include "v8_allocator.hpp"
+#include "v8_async_executor.hpp"
+#include "v8_code_cache.hpp"
+#include "v8_platform.hpp"
+
+namespace wilton {
+namespace v8eng {
+
+namespace { // anonymous
+
+// engine stops waiting for the slow preload and loads the module itself
+const std::chrono::seconds find_timeout{10};
+
+sl::json::value json_u64(uint64_t num) {
+    return sl::json::value(static_cast<int64_t>(num));
+}
+
+std::shared_ptr<std::string> load_resource(const std::string& path) {
+    char* code = nullptr;
+    int code_len = 0;
+    auto err_load = wilton_load_resource(path.c_str(), static_cast<int>(path.length()),
+            std::addressof(code), std::addressof(code_len));
+    if (nullptr != err_load) {
+        support::throw_wilton_error(err_load, TRACEMSG(err_load));
+    }
+    auto deferred = sl::support::defer([code] () STATICLIB_NOEXCEPT {
+        wilton_free(code);
+    });
+    return std::make_shared<std::string>(code, static_cast<size_t>(code_len));
+}
+
+// eager compilation includes inner functions into the cache,
+// so engines skip lazy compilation of them too
+bool precompile_module(v8::Isolate* isolate, const std::string& path, const std::string& code) {
+    v8::HandleScope handle_scope(isolate);
+    auto ctx = v8::Context::New(isolate);
+    v8::Context::Scope ctx_scope(ctx);
+    auto code_maybe = v8::String::NewFromUtf8(isolate, code.data(),
+            v8::NewStringType::kNormal, static_cast<int>(code.length()));
+    // key must match the one created by 'WILTON_load'
+    auto path_short = support::script_engine_map_detail::shorten_script_path(path);
+    auto path_maybe = v8::String::NewFromUtf8(isolate, path_short.c_str(),
+            v8::NewStringType::kNormal, static_cast<int>(path_short.length()));
+    if (code_maybe.IsEmpty() || path_maybe.IsEmpty()) {
+        return false;
+    }
+    v8::TryCatch trycatch(isolate);
+    v8::ScriptOrigin origin(path_maybe.ToLocalChecked());
+    v8::ScriptCompiler::Source source(code_maybe.ToLocalChecked(), origin);
+    auto script_maybe = v8::ScriptCompiler::CompileUnboundScript(isolate, std::addressof(source),
+            v8::ScriptCompiler::kEagerCompile);
+    if (script_maybe.IsEmpty()) {
+        // syntax errors are reported by the engine on actual load
+        return false;
+    }
+    auto data = std::unique_ptr<v8::ScriptCompiler::CachedData>(
+            v8::ScriptCompiler::CreateCodeCache(script_maybe.ToLocalChecked()));
+    if (nullptr == data.get() || data->length <= 0) {
+        return false;
+    }
+    auto& cache = v8_code_cache::shared();
+    auto key = cache.make_key(path_short, code.data(), code.length());
+    cache.put(key, reinterpret_cast<const char*>(data->data), static_cast<size_t>(data->length));
+    return true;
+}
+
+} // namespace
+
+v8_module_preloader::v8_module_preloader() :
+modules(0),
+bytes(0),
+precompiled(0),
+failures(0),
+hits(0),
+waits(0),
+timeouts(0),
+elapsed_us(0) { }
+
+void v8_module_preloader::start(const std::vector<std::string>& paths, size_t tasks_count, bool precompile) {
+    if (paths.empty()) {
+        return;
+    }
+    auto tc = std::max(std::min(tasks_count, paths.size()), static_cast<size_t>(1));
+    auto chunks = std::vector<std::shared_ptr<std::vector<std::string>>>();
+    for (size_t i = 0; i < tc; i++) {
+        chunks.emplace_back(std::make_shared<std::vector<std::string>>());
+    }
+    {
+        std::lock_guard<std::mutex> guard{mutex};
+        for (size_t i = 0; i < paths.size(); i++) {
+            auto& pa = paths.at(i);
+            if (entries.end() == entries.find(pa)) {
+                entries.emplace(pa, std::make_shared<entry>());
+                chunks.at(i % tc)->push_back(pa);
+            }
+        }
+    }
+    wilton::support::log_info("wilton.engine.v8.preload", std::string() + "Preloading modules," +
+            " count: [" + sl::support::to_string(paths.size()) + "]," +
+            " tasks: [" + sl::support::to_string(tc) + "]," +
+            " precompile: [" + sl::support::to_string_bool(precompile) + "]");
+    auto& executor = v8_async_executor::shared();
+    for (auto& ch : chunks) {
+        executor.submit([this, ch, precompile] {
+            this->run_task(ch, precompile);
+        });
+    }
+}
+
+std::shared_ptr<std::string> v8_module_preloader::find(const std::string& path) {
+    std::unique_lock<std::mutex> guard{mutex};
+    auto it = entries.find(path);
+    if (entries.end() == it) {
+        return std::shared_ptr<std::string>();
+    }
+    auto en = it->second;
+    if (!en->ready) {
+        waits.fetch_add(1, std::memory_order_relaxed);
+        auto ready = cv.wait_for(guard, find_timeout, [&en] {
+            return en->ready;
+        });
+        if (!ready) {
+            timeouts.fetch_add(1, std::memory_order_relaxed);
+            return std::shared_ptr<std::string>();
+        }
+    }
+    if (nullptr != en->code.get()) {
+        hits.fetch_add(1, std::memory_order_relaxed);
+    }
+    return en->code;
+}
+
+sl::json::value v8_module_preloader::stats() const {
+    return {
+        { "modules", json_u64(modules.load()) },
+        { "bytes", json_u64(bytes.load()) },
+        { "precompiled", json_u64(precompiled.load()) },
+        { "failures", json_u64(failures.load()) },
+        { "hits", json_u64(hits.load()) },
+        { "waits", json_u64(waits.load()) },
+        { "timeouts", json_u64(timeouts.load()) },
+        { "elapsed_us", json_u64(elapsed_us.load()) }
+    };
+}
+
+std::vector<std::string> v8_module_preloader::load_manifest(const std::string& manifest_path) {
+    auto code = load_resource(manifest_path);
+    auto json = sl::json::loads(*code);
+    auto res = std::vector<std::string>();
+    for (auto& va : json.as_array_or_throw(manifest_path)) {
+        res.emplace_back(va.as_string_nonempty_or_throw(manifest_path));
+    }
+    return res;
+}
+
+v8_module_preloader& v8_module_preloader::shared() {
+    static v8_module_preloader preloader;
+    return preloader;
+}
+
+void v8_module_preloader::run_task(std::shared_ptr<std::vector<std::string>> paths, bool precompile) {
+    auto start = std::chrono::steady_clock::now();
+    // single isolate is used for all modules of this task
+    v8::Isolate* isolate = nullptr;
+    if (precompile) {
+        v8::Isolate::CreateParams create_params;
+        create_params.array_buffer_allocator = shared_array_buffer_allocator();
+        isolate = v8::Isolate::New(create_params);
+    }
+    auto deferred = sl::support::defer([isolate] () STATICLIB_NOEXCEPT {
+        if (nullptr != isolate) {
+            isolate->Dispose();
+            v8_platform::shared().dispose_isolate(isolate);
+        }
+    });
+    // entries not reached because of an error are released for lazy loading
+    size_t done = 0;
+    auto deferred_rest = sl::support::defer([this, paths, &done] () STATICLIB_NOEXCEPT {
+        for (size_t i = done; i < paths->size(); i++) {
+            complete(paths->at(i), std::shared_ptr<std::string>());
+        }
+    });
+    for (; done < paths->size(); done++) {
+        auto& pa = paths->at(done);
+        auto code = std::shared_ptr<std::string>();
+        // source is published after compilation, so engine waiting
+        // for it gets the code cache entry too
+        auto deferred_complete = sl::support::defer([this, &pa, &code] () STATICLIB_NOEXCEPT {
+            complete(pa, std::move(code));
+        });
+        try {
+            code = load_resource(pa);
+            modules.fetch_add(1, std::memory_order_relaxed);
+            bytes.fetch_add(code->length(), std::memory_order_relaxed);
+            if (nullptr != isolate) {
+                v8::Locker locker(isolate);
+                v8::Isolate::Scope isolate_scope(isolate);
+                if (precompile_module(isolate, pa, *code)) {
+                    precompiled.fetch_add(1, std::memory_order_relaxed);
+                }
+            }
+        } catch (const std::exception& e) {
+            failures.fetch_add(1, std::memory_order_relaxed);
+            // module will be loaded lazily reporting the error to caller
+            wilton::support::log_warn("wilton.engine.v8.preload", TRACEMSG(e.what() +
+                    "\nError preloading module, path: [" + pa + "]"));
+        }
+    }
+    auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::steady_clock::now() - start);
+    elapsed_us.fetch_add(static_cast<uint64_t>(elapsed.count()), std::memory_order_relaxed);
+}
+
+void v8_module_preloader::complete(const std::string& path, std::shared_ptr<std::string> code) {
+    {
+        std::lock_guard<std::mutex> guard{mutex};
+        auto it = entries.find(path);
+        if (entries.end() != it && !it->second->ready) {
+            it->second->code = std::move(code);
+            it->second->ready = true;
+        }
+    }
+    cv.notify_all();
+}
+
+} // namespace
+}
@@ -0,0 +1,106 @@
+/*
+ * Copyright 2026, agent
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * File:   v8_module_preloader.hpp
+ * Author: agent
+ */
+
+#ifndef WILTON_V8_MODULE_PRELOADER_HPP
+#define WILTON_V8_MODULE_PRELOADER_HPP
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "staticlib/json.hpp"
+
+namespace wilton {
+namespace v8eng {
+
+/**
+ * Reads modules listed in the preload manifest on the async executor
+ * threads before they are requested by the engines, and, when the code
+ * cache is enabled, compiles them eagerly to populate it
+ */
+class v8_module_preloader {
+    class entry {
+    public:
+        bool ready = false;
+        std::shared_ptr<std::string> code;
+    };
+
+    std::mutex mutex;
+    std::condition_variable cv;
+    std::unordered_map<std::string, std::shared_ptr<entry>> entries;
+
+    std::atomic<uint64_t> modules;
+    std::atomic<uint64_t> bytes;
+    std::atomic<uint64_t> precompiled;
+    std::atomic<uint64_t> failures;
+    std::atomic<uint64_t> hits;
+    std::atomic<uint64_t> waits;
+    std::atomic<uint64_t> timeouts;
+    std::atomic<uint64_t> elapsed_us;
+
+public:
+    v8_module_preloader();
+
+    v8_module_preloader(const v8_module_preloader&) = delete;
+
+    v8_module_preloader& operator=(const v8_module_preloader&) = delete;
+
+    /**
+     * Starts loading modules in background, returns immediately
+     *
+     * @param paths module paths in the same form they are passed to 'WILTON_load'
+     * @param tasks_count number of parallel tasks
+     * @param precompile whether to create code cache entries
+     */
+    void start(const std::vector<std::string>& paths, size_t tasks_count, bool precompile);
+
+    /**
+     * Returns preloaded source, waiting for it if loading is in progress,
+     * wait is bounded so a stuck preload task cannot block the engine
+     *
+     * @param path module path
+     * @return module source or null if module is not preloaded
+     *         or is not ready in time
+     */
+    std::shared_ptr<std::string> find(const std::string& path);
+
+    sl::json::value stats() const;
+
+    static std::vector<std::string> load_manifest(const std::string& manifest_path);
+
+    static v8_module_preloader& shared();
+
+private:
+    void run_task(std::shared_ptr<std::vector<std::string>> paths, bool precompile);
+
+    void complete(const std::string& path, std::shared_ptr<std::string> code);
+};
+
+} // namespace
+}
+
+#endif /* WILTON_V8_MODULE_PRELOADER_HPP */
+
@@ -0,0 +1,474 @@
+/*
+ * Copyright 2026, agent
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * File:   v8_platform.cpp
+ * Author: agent
+ */
+
+#include "v8_platform.hpp"
+
+#include <algorithm>
+#include <deque>
+#include <limits>
+
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#endif // __linux__
+
+#include "staticlib/support.hpp"
+
+#include "wilton/support/logging.hpp"
+
+namespace wilton {
+namespace v8eng {
+
+namespace { // anonymous
+
+const size_t no_worker = std::numeric_limits<size_t>::max();
+
+thread_local size_t current_worker = no_worker;
+
+class queued_task {
+public:
+    std::unique_ptr<v8::Task> task;
+    std::chrono::steady_clock::time_point posted_at;
+
+    queued_task() { }
+
+    queued_task(std::unique_ptr<v8::Task> task, std::chrono::steady_clock::time_point posted_at) :
+    task(std::move(task)),
+    posted_at(posted_at) { }
+};
+
+std::chrono::steady_clock::time_point deadline_after(double delay_in_seconds) {
+    auto delay = std::chrono::duration<double>(std::max(delay_in_seconds, 0.0));
+    return std::chrono::steady_clock::now() + std::chrono::duration_cast<std::chrono::steady_clock::duration>(delay);
+}
+
+uint64_t micros_since(std::chrono::steady_clock::time_point start) {
+    auto elapsed = std::chrono::steady_clock::now() - start;
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(elapsed).count());
+}
+
+void pin_to_cpu(size_t idx) {
+#ifdef __linux__
+    auto cpus = std::max(std::thread::hardware_concurrency(), 1u);
+    cpu_set_t set;
+    CPU_ZERO(std::addressof(set));
+    CPU_SET(static_cast<int>(idx % cpus), std::addressof(set));
+    auto err = pthread_setaffinity_np(pthread_self(), sizeof(set), std::addressof(set));
+    if (0 != err) {
+        wilton::support::log_warn("wilton.engine.v8.platform", std::string() + "Error setting CPU affinity," +
+                " worker: [" + sl::support::to_string(idx) + "], code: [" + sl::support::to_string(err) + "]");
+    }
+#else
+    (void) idx;
+#endif // __linux__
+}
+
+sl::json::value json_u64(uint64_t num) {
+    return sl::json::value(static_cast<int64_t>(num));
+}
+
+} // namespace
+
+class v8_platform::worker_queue {
+public:
+    std::mutex mutex;
+    std::deque<queued_task> tasks;
+    std::atomic<uint64_t> busy_us;
+
+    worker_queue() :
+    busy_us(0) { }
+};
+
+class v8_platform::foreground_queue {
+public:
+    std::mutex mutex;
+    std::deque<queued_task> tasks;
+    std::multimap<std::chrono::steady_clock::time_point, std::unique_ptr<v8::Task>> delayed;
+    std::deque<std::unique_ptr<v8::IdleTask>> idle;
+};
+
+class v8_platform::worker_runner : public v8::TaskRunner {
+    v8_platform* platform;
+
+public:
+    explicit worker_runner(v8_platform* platform) :
+    platform(platform) { }
+
+    void PostTask(std::unique_ptr<v8::Task> task) override {
+        platform->post_worker_task(std::move(task));
+    }
+
+    void PostDelayedTask(std::unique_ptr<v8::Task> task, double delay_in_seconds) override {
+        platform->post_delayed_worker_task(std::move(task), delay_in_seconds);
+    }
+
+    // not called by V8 as idle tasks are disabled for workers
+    void PostIdleTask(std::unique_ptr<v8::IdleTask>) override { }
+
+    bool IdleTasksEnabled() override {
+        return false;
+    }
+};
+
+class v8_platform::foreground_runner : public v8::TaskRunner {
+    v8_platform* platform;
+    std::shared_ptr<foreground_queue> queue;
+
+public:
+    foreground_runner(v8_platform* platform, std::shared_ptr<foreground_queue> queue) :
+    platform(platform),
+    queue(std::move(queue)) { }
+
+    void PostTask(std::unique_ptr<v8::Task> task) override {
+        std::lock_guard<std::mutex> guard{queue->mutex};
+        queue->tasks.emplace_back(std::move(task), std::chrono::steady_clock::now());
+        platform->foreground_posted.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    void PostDelayedTask(std::unique_ptr<v8::Task> task, double delay_in_seconds) override {
+        std::lock_guard<std::mutex> guard{queue->mutex};
+        queue->delayed.emplace(deadline_after(delay_in_seconds), std::move(task));
+        platform->foreground_posted.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    void PostIdleTask(std::unique_ptr<v8::IdleTask> task) override {
+        std::lock_guard<std::mutex> guard{queue->mutex};
+        queue->idle.emplace_back(std::move(task));
+    }
+
+    bool IdleTasksEnabled() override {
+        return true;
+    }
+};
+
+v8_platform::v8_platform(size_t threads_count, bool affinity) :
+affinity(affinity),
+started_at(std::chrono::steady_clock::now()),
+tracing(new v8::TracingController()),
+pending(0),
+next_queue(0),
+tasks_posted(0),
+tasks_run(0),
+tasks_stolen(0),
+foreground_posted(0),
+foreground_run(0),
+idle_run(0) {
+    auto count = threads_count;
+    if (0 == count) {
+        auto cpus = static_cast<size_t>(std::thread::hardware_concurrency());
+        count = cpus > 1 ? cpus - 1 : 1;
+    }
+    this->worker_task_runner = std::make_shared<worker_runner>(this);
+    for (size_t i = 0; i < count; i++) {
+        queues.emplace_back(new worker_queue());
+    }
+    for (size_t i = 0; i < count; i++) {
+        workers.emplace_back(&v8_platform::run_worker, this, i);
+    }
+}
+
+v8_platform::~v8_platform() STATICLIB_NOEXCEPT {
+    {
+        std::lock_guard<std::mutex> guard{mutex};
+        stopping = true;
+    }
+    cv.notify_all();
+    for (auto& th : workers) {
+        th.join();
+    }
+}
+
+int v8_platform::NumberOfWorkerThreads() {
+    return static_cast<int>(workers.size());
+}
+
+size_t v8_platform::NumberOfAvailableBackgroundThreads() {
+    return workers.size();
+}
+
+std::shared_ptr<v8::TaskRunner> v8_platform::GetForegroundTaskRunner(v8::Isolate* isolate) {
+    return std::make_shared<foreground_runner>(this, foreground_of(isolate));
+}
+
+std::shared_ptr<v8::TaskRunner> v8_platform::GetBackgroundTaskRunner(v8::Isolate*) {
+    return worker_task_runner;
+}
+
+std::shared_ptr<v8::TaskRunner> v8_platform::GetWorkerThreadsTaskRunner(v8::Isolate*) {
+    return worker_task_runner;
+}
+
+void v8_platform::CallOnBackgroundThread(v8::Task* task, ExpectedRuntime) {
+    post_worker_task(std::unique_ptr<v8::Task>(task));
+}
+
+void v8_platform::CallOnWorkerThread(std::unique_ptr<v8::Task> task) {
+    post_worker_task(std::move(task));
+}
+
+void v8_platform::CallOnForegroundThread(v8::Isolate* isolate, v8::Task* task) {
+    foreground_runner(this, foreground_of(isolate)).PostTask(std::unique_ptr<v8::Task>(task));
+}
+
+void v8_platform::CallDelayedOnForegroundThread(v8::Isolate* isolate, v8::Task* task, double delay_in_seconds) {
+    foreground_runner(this, foreground_of(isolate)).PostDelayedTask(std::unique_ptr<v8::Task>(task),
+            delay_in_seconds);
+}
+
+void v8_platform::CallIdleOnForegroundThread(v8::Isolate* isolate, v8::IdleTask* task) {
+    foreground_runner(this, foreground_of(isolate)).PostIdleTask(std::unique_ptr<v8::IdleTask>(task));
+}
+
+bool v8_platform::IdleTasksEnabled(v8::Isolate*) {
+    return true;
+}
+
+double v8_platform::MonotonicallyIncreasingTime() {
+    // the same clock is used for idle deadlines
+    auto now = std::chrono::steady_clock::now().time_since_epoch();
+    return std::chrono::duration<double>(now).count();
+}
+
+double v8_platform::CurrentClockTimeMillis() {
+    return SystemClockTimeMillis();
+}
+
+v8::TracingController* v8_platform::GetTracingController() {
+    return tracing.get();
+}
+
+void v8_platform::run_foreground_tasks(v8::Isolate* isolate) {
+    auto queue = std::shared_ptr<foreground_queue>();
+    {
+        std::lock_guard<std::mutex> guard{foreground_mutex};
+        auto it = foreground.find(isolate);
+        if (foreground.end() == it) {
+            return;
+        }
+        queue = it->second;
+    }
+    // tasks posted while running are left for the next call
+    auto batch = std::deque<queued_task>();
+    {
+        std::lock_guard<std::mutex> guard{queue->mutex};
+        auto now = std::chrono::steady_clock::now();
+        auto due_end = queue->delayed.upper_bound(now);
+        for (auto it = queue->delayed.begin(); it != due_end; ++it) {
+            // latency is counted from the deadline
+            queue->tasks.emplace_back(std::move(it->second), it->first);
+        }
+        queue->delayed.erase(queue->delayed.begin(), due_end);
+        batch.swap(queue->tasks);
+    }
+    for (auto& qt : batch) {
+        queue_latency.record(micros_since(qt.posted_at));
+        auto start = std::chrono::steady_clock::now();
+        qt.task->Run();
+        run_time.record_since(start);
+        foreground_run.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+void v8_platform::run_idle_tasks(v8::Isolate* isolate, double deadline_in_seconds) {
+    auto queue = std::shared_ptr<foreground_queue>();
+    {
+        std::lock_guard<std::mutex> guard{foreground_mutex};
+        auto it = foreground.find(isolate);
+        if (foreground.end() == it) {
+            return;
+        }
+        queue = it->second;
+    }
+    while (MonotonicallyIncreasingTime() < deadline_in_seconds) {
+        auto task = std::unique_ptr<v8::IdleTask>();
+        {
+            std::lock_guard<std::mutex> guard{queue->mutex};
+            if (queue->idle.empty()) {
+                return;
+            }
+            task = std::move(queue->idle.front());
+            queue->idle.pop_front();
+        }
+        task->Run(deadline_in_seconds);
+        idle_run.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+void v8_platform::dispose_isolate(v8::Isolate* isolate) {
+    std::lock_guard<std::mutex> guard{foreground_mutex};
+    foreground.erase(isolate);
+}
+
+sl::json::value v8_platform::stats() {
+    auto uptime_us = std::max(micros_since(started_at), static_cast<uint64_t>(1));
+    auto depth = std::vector<sl::json::value>();
+    auto utilization = std::vector<sl::json::value>();
+    for (auto& qu : queues) {
+        {
+            std::lock_guard<std::mutex> guard{qu->mutex};
+            depth.emplace_back(json_u64(qu->tasks.size()));
+        }
+        auto busy = qu->busy_us.load(std::memory_order_relaxed);
+        utilization.emplace_back(static_cast<double>(busy) / static_cast<double>(uptime_us));
+    }
+    size_t delayed_count = 0;
+    {
+        std::lock_guard<std::mutex> guard{mutex};
+        delayed_count = delayed.size();
+    }
+    size_t isolates = 0;
+    {
+        std::lock_guard<std::mutex> guard{foreground_mutex};
+        isolates = foreground.size();
+    }
+    auto latency = latency_data();
+    queue_latency.add_to(latency);
+    auto run = latency_data();
+    run_time.add_to(run);
+    return {
+        { "workers", json_u64(workers.size()) },
+        { "affinity", affinity },
+        { "queue_depth", std::move(depth) },
+        { "delayed", json_u64(delayed_count) },
+        { "utilization", std::move(utilization) },
+        { "tasks_posted", json_u64(tasks_posted.load()) },
+        { "tasks_run", json_u64(tasks_run.load()) },
+        { "tasks_stolen", json_u64(tasks_stolen.load()) },
+        { "foreground", {
+            { "isolates", json_u64(isolates) },
+            { "posted", json_u64(foreground_posted.load()) },
+            { "run", json_u64(foreground_run.load()) },
+            { "idle_run", json_u64(idle_run.load()) }
+        }},
+        { "latency", latency.to_json() },
+        { "run_time", run.to_json() }
+    };
+}
+
+v8_platform& v8_platform::shared(size_t threads_count, bool affinity) {
+    // threads count is taken from the first call made from v8_engine::initialize
+    static v8_platform* platform = new v8_platform(threads_count, affinity);
+    return *platform;
+}
+
+void v8_platform::post_worker_task(std::unique_ptr<v8::Task> task) {
+    auto now = std::chrono::steady_clock::now();
+    // tasks posted from workers stay local to keep the data hot in cache
+    auto idx = current_worker < queues.size() ? current_worker :
+            next_queue.fetch_add(1, std::memory_order_relaxed) % queues.size();
+    {
+        // counted before being queued, so it is never decremented below zero by a taker
+        std::lock_guard<std::mutex> guard{mutex};
+        pending.fetch_add(1, std::memory_order_relaxed);
+    }
+    {
+        auto& qu = queues.at(idx);
+        std::lock_guard<std::mutex> guard{qu->mutex};
+        qu->tasks.emplace_back(std::move(task), now);
+    }
+    tasks_posted.fetch_add(1, std::memory_order_relaxed);
+    cv.notify_one();
+}
+
+void v8_platform::post_delayed_worker_task(std::unique_ptr<v8::Task> task, double delay_in_seconds) {
+    {
+        std::lock_guard<std::mutex> guard{mutex};
+        delayed.emplace(deadline_after(delay_in_seconds), std::move(task));
+    }
+    // sleeping worker must recalculate its wake up time
+    cv.notify_one();
+}
+
+std::shared_ptr<v8_platform::foreground_queue> v8_platform::foreground_of(v8::Isolate* isolate) {
+    std::lock_guard<std::mutex> guard{foreground_mutex};
+    auto it = foreground.find(isolate);
+    if (foreground.end() != it) {
+        return it->second;
+    }
+    auto queue = std::make_shared<foreground_queue>();
+    foreground.emplace(isolate, queue);
+    return queue;
+}
+
+void v8_platform::run_worker(size_t idx) {
+    current_worker = idx;
+    if (affinity) {
+        pin_to_cpu(idx);
+    }
+    auto& own = queues.at(idx);
+    for (;;) {
+        // take own tasks in FIFO order, steal from the tail of others
+        auto qt = queued_task();
+        {
+            std::lock_guard<std::mutex> guard{own->mutex};
+            if (!own->tasks.empty()) {
+                qt = std::move(own->tasks.front());
+                own->tasks.pop_front();
+            }
+        }
+        for (size_t i = 1; nullptr == qt.task.get() && i < queues.size(); i++) {
+            auto& other = queues.at((idx + i) % queues.size());
+            std::lock_guard<std::mutex> guard{other->mutex};
+            if (!other->tasks.empty()) {
+                qt = std::move(other->tasks.back());
+                other->tasks.pop_back();
+                tasks_stolen.fetch_add(1, std::memory_order_relaxed);
+            }
+        }
+        if (nullptr != qt.task.get()) {
+            pending.fetch_sub(1, std::memory_order_relaxed);
+            queue_latency.record(micros_since(qt.posted_at));
+            auto start = std::chrono::steady_clock::now();
+            qt.task->Run();
+            auto elapsed = micros_since(start);
+            run_time.record(elapsed);
+            own->busy_us.fetch_add(elapsed, std::memory_order_relaxed);
+            tasks_run.fetch_add(1, std::memory_order_relaxed);
+            continue;
+        }
+        auto due = std::vector<queued_task>();
+        {
+            std::unique_lock<std::mutex> guard{mutex};
+            auto ready = [this] {
+                return stopping || pending.load(std::memory_order_relaxed) > 0;
+            };
+            if (delayed.empty()) {
+                cv.wait(guard, ready);
+            } else {
+                cv.wait_until(guard, delayed.begin()->first, ready);
+            }
+            if (stopping) {
+                return;
+            }
+            auto due_end = delayed.upper_bound(std::chrono::steady_clock::now());
+            for (auto it = delayed.begin(); it != due_end; ++it) {
+                due.emplace_back(std::move(it->second), it->first);
+            }
+            delayed.erase(delayed.begin(), due_end);
+        }
+        for (auto& dt : due) {
+            post_worker_task(std::move(dt.task));
+        }
+    }
+}
+
+} // namespace
+}
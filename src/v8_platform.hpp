@@ -0,0 +1,176 @@
+/*
+ * Copyright 2026, agent
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * File:   v8_platform.hpp
+ * Author: agent
+ */
+
+#ifndef WILTON_V8_PLATFORM_HPP
+#define WILTON_V8_PLATFORM_HPP
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "v8.h"
+#include "v8-platform.h"
+
+#include "staticlib/config.hpp"
+#include "staticlib/json.hpp"
+
+#include "v8_metrics.hpp"
+
+namespace wilton {
+namespace v8eng {
+
+/**
+ * V8 platform with a fixed set of workers, each worker has its own queue
+ * and steals tasks from other queues when idle. Foreground tasks are queued
+ * per isolate and are run by the engine that owns the isolate.
+ */
+class v8_platform : public v8::Platform {
+    class worker_queue;
+    class foreground_queue;
+    class worker_runner;
+    class foreground_runner;
+
+    std::vector<std::unique_ptr<worker_queue>> queues;
+    std::vector<std::thread> workers;
+    bool affinity;
+    std::chrono::steady_clock::time_point started_at;
+    std::unique_ptr<v8::TracingController> tracing;
+    std::shared_ptr<worker_runner> worker_task_runner;
+
+    // guards sleeping workers and delayed tasks
+    std::mutex mutex;
+    std::condition_variable cv;
+    std::multimap<std::chrono::steady_clock::time_point, std::unique_ptr<v8::Task>> delayed;
+    std::atomic<size_t> pending;
+    std::atomic<size_t> next_queue;
+    bool stopping = false;
+
+    std::mutex foreground_mutex;
+    std::unordered_map<v8::Isolate*, std::shared_ptr<foreground_queue>> foreground;
+
+    std::atomic<uint64_t> tasks_posted;
+    std::atomic<uint64_t> tasks_run;
+    std::atomic<uint64_t> tasks_stolen;
+    std::atomic<uint64_t> foreground_posted;
+    std::atomic<uint64_t> foreground_run;
+    std::atomic<uint64_t> idle_run;
+    latency_histogram queue_latency;
+    latency_histogram run_time;
+
+public:
+    v8_platform(size_t threads_count, bool affinity);
+
+    ~v8_platform() STATICLIB_NOEXCEPT;
+
+    v8_platform(const v8_platform&) = delete;
+
+    v8_platform& operator=(const v8_platform&) = delete;
+
+    // v8::Platform
+
+    int NumberOfWorkerThreads() override;
+
+    size_t NumberOfAvailableBackgroundThreads() override;
+
+    std::shared_ptr<v8::TaskRunner> GetForegroundTaskRunner(v8::Isolate* isolate) override;
+
+    std::shared_ptr<v8::TaskRunner> GetBackgroundTaskRunner(v8::Isolate* isolate) override;
+
+    std::shared_ptr<v8::TaskRunner> GetWorkerThreadsTaskRunner(v8::Isolate* isolate) override;
+
+    void CallOnBackgroundThread(v8::Task* task, ExpectedRuntime expected_runtime) override;
+
+    void CallOnWorkerThread(std::unique_ptr<v8::Task> task) override;
+
+    void CallOnForegroundThread(v8::Isolate* isolate, v8::Task* task) override;
+
+    void CallDelayedOnForegroundThread(v8::Isolate* isolate, v8::Task* task, double delay_in_seconds) override;
+
+    void CallIdleOnForegroundThread(v8::Isolate* isolate, v8::IdleTask* task) override;
+
+    bool IdleTasksEnabled(v8::Isolate* isolate) override;
+
+    double MonotonicallyIncreasingTime() override;
+
+    double CurrentClockTimeMillis() override;
+
+    v8::TracingController* GetTracingController() override;
+
+    // engine API
+
+    /**
+     * Runs foreground tasks posted for the isolate, must be called
+     * with the isolate locked and entered
+     *
+     * @param isolate isolate to run tasks for
+     */
+    void run_foreground_tasks(v8::Isolate* isolate);
+
+    /**
+     * Runs idle tasks posted for the isolate until the deadline,
+     * must be called with the isolate locked and entered
+     *
+     * @param isolate isolate to run tasks for
+     * @param deadline_in_seconds absolute platform time
+     */
+    void run_idle_tasks(v8::Isolate* isolate, double deadline_in_seconds);
+
+    /**
+     * Drops tasks left for the disposed isolate
+     *
+     * @param isolate disposed isolate
+     */
+    void dispose_isolate(v8::Isolate* isolate);
+
+    sl::json::value stats();
+
+    /**
+     * Platform instance, created on the first call made from v8_engine::initialize,
+     * it is never destroyed as V8 may access it from static destructors
+     *
+     * @param threads_count number of workers, 0 for one less than number of CPUs
+     * @param affinity whether to pin workers to CPUs
+     * @return platform instance
+     */
+    static v8_platform& shared(size_t threads_count = 0, bool affinity = false);
+
+private:
+    void post_worker_task(std::unique_ptr<v8::Task> task);
+
+    void post_delayed_worker_task(std::unique_ptr<v8::Task> task, double delay_in_seconds);
+
+    std::shared_ptr<foreground_queue> foreground_of(v8::Isolate* isolate);
+
+    void run_worker(size_t idx);
+};
+
+} // namespace
+}
+
+#endif /* WILTON_V8_PLATFORM_HPP */
+
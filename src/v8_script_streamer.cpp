@@ -0,0 +1,160 @@
+/*
+ * Copyright 2026, agent
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * File:   v8_script_streamer.cpp
+ * Author: agent
+ */
+
+#include "v8_script_streamer.hpp"
+
+#include <algorithm>
+#include <condition_variable>
+#include <cstring>
+#include <memory>
+#include <mutex>
+
+#include "v8-platform.h"
+
+#include "staticlib/support.hpp"
+
+#include "wilton/support/exception.hpp"
+
+namespace wilton {
+namespace v8eng {
+
+namespace { // anonymous
+
+// at least 2 bytes required to handle split UTF-8 sequences
+const size_t chunk_size = 64 * 1024;
+
+// feeds in-memory source to the parser by chunks, chunks
+// are copied on the worker thread as the parser consumes them
+class chunked_source_stream : public v8::ScriptCompiler::ExternalSourceStream {
+    const char* code;
+    size_t code_len;
+    size_t pos = 0;
+
+public:
+    chunked_source_stream(const char* code, size_t code_len) :
+    code(code),
+    code_len(code_len) { }
+
+    // parser takes ownership of the chunk
+    size_t GetMoreData(const uint8_t** src) override {
+        if (pos >= code_len) {
+            return 0;
+        }
+        auto len = std::min(chunk_size, code_len - pos);
+        auto chunk = new uint8_t[len];
+        std::memcpy(chunk, code + pos, len);
+        pos += len;
+        *src = chunk;
+        return len;
+    }
+};
+
+class streaming_state {
+public:
+    std::mutex mutex;
+    std::condition_variable cv;
+    bool done = false;
+    std::chrono::microseconds parse_time{0};
+
+    std::chrono::microseconds await() {
+        std::unique_lock<std::mutex> guard{mutex};
+        cv.wait(guard, [this] {
+            return done;
+        });
+        return parse_time;
+    }
+};
+
+class streaming_task : public v8::Task {
+    std::unique_ptr<v8::ScriptCompiler::ScriptStreamingTask> task;
+    std::shared_ptr<streaming_state> state;
+
+public:
+    streaming_task(v8::ScriptCompiler::ScriptStreamingTask* task, std::shared_ptr<streaming_state> state) :
+    task(task),
+    state(std::move(state)) { }
+
+    void Run() override {
+        auto start = std::chrono::steady_clock::now();
+        task->Run();
+        auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(
+                std::chrono::steady_clock::now() - start);
+        std::lock_guard<std::mutex> guard{state->mutex};
+        state->parse_time = elapsed;
+        state->done = true;
+        state->cv.notify_all();
+    }
+};
+
+} // namespace
+
+v8_script_streamer::v8_script_streamer() :
+platform(nullptr),
+min_size_bytes(0) { }
+
+void v8_script_streamer::configure(v8::Platform* platform, size_t min_size_bytes) {
+    this->platform.store(platform);
+    this->min_size_bytes.store(min_size_bytes);
+}
+
+bool v8_script_streamer::is_enabled_for(size_t code_len) const {
+    auto min_size = min_size_bytes.load(std::memory_order_relaxed);
+    return nullptr != platform.load(std::memory_order_relaxed) &&
+            min_size > 0 && code_len >= min_size;
+}
+
+v8::MaybeLocal<v8::Script> v8_script_streamer::compile(v8::Local<v8::Context>& ctx,
+        const char* code, size_t code_len, const std::function<v8::Local<v8::String>()>& make_source_val,
+        v8::ScriptOrigin& origin, v8_streaming_times& times) {
+    auto pl = platform.load();
+    if (nullptr == pl) {
+        throw support::exception(TRACEMSG("Script streaming is not configured"));
+    }
+    auto isolate = ctx->GetIsolate();
+    // source takes ownership of the stream
+    v8::ScriptCompiler::StreamedSource source(new chunked_source_stream(code, code_len),
+            v8::ScriptCompiler::StreamedSource::UTF8);
+    auto state = std::make_shared<streaming_state>();
+    auto task = v8::ScriptCompiler::StartStreamingScript(isolate, std::addressof(source));
+    pl->CallOnWorkerThread(std::unique_ptr<v8::Task>(new streaming_task(task, state)));
+    // worker uses the source on this stack until it is done
+    bool awaited = false;
+    auto deferred = sl::support::defer([&awaited, state] () STATICLIB_NOEXCEPT {
+        if (!awaited) {
+            state->await();
+        }
+    });
+    auto source_val = make_source_val();
+    auto wait_start = std::chrono::steady_clock::now();
+    times.parse = state->await();
+    awaited = true;
+    times.wait = std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::steady_clock::now() - wait_start);
+    return v8::ScriptCompiler::Compile(ctx, std::addressof(source), source_val, origin);
+}
+
+v8_script_streamer& v8_script_streamer::shared() {
+    static v8_script_streamer streamer;
+    return streamer;
+}
+
+} // namespace
+}
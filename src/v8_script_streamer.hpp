@@ -0,0 +1,94 @@
+/*
+ * Copyright 2026, agent
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * File:   v8_script_streamer.hpp
+ * Author: agent
+ */
+
+#ifndef WILTON_V8_SCRIPT_STREAMER_HPP
+#define WILTON_V8_SCRIPT_STREAMER_HPP
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+
+#include "v8.h"
+
+namespace wilton {
+namespace v8eng {
+
+/**
+ * Timings of a single streamed compilation
+ */
+class v8_streaming_times {
+public:
+    // parse on worker thread
+    std::chrono::microseconds parse{0};
+    // calling thread blocked on the parse
+    std::chrono::microseconds wait{0};
+};
+
+/**
+ * Compiles large scripts using V8 streaming API, source is parsed
+ * on platform worker threads, calling thread creates the source string
+ * while the parse is running and only finalizes the compilation
+ */
+class v8_script_streamer {
+    std::atomic<v8::Platform*> platform;
+    std::atomic<size_t> min_size_bytes;
+
+public:
+    v8_script_streamer();
+
+    v8_script_streamer(const v8_script_streamer&) = delete;
+
+    v8_script_streamer& operator=(const v8_script_streamer&) = delete;
+
+    /**
+     * @param platform platform to run parse tasks on
+     * @param min_size_bytes scripts smaller than this are compiled
+     *        synchronously, 0 disables streaming
+     */
+    void configure(v8::Platform* platform, size_t min_size_bytes);
+
+    bool is_enabled_for(size_t code_len) const;
+
+    /**
+     * Parses the code on worker thread, must be called with the isolate locked
+     *
+     * @param ctx current context
+     * @param code UTF-8 source, must stay valid until return
+     * @param code_len source length in bytes
+     * @param make_source_val creates the same source as JS string,
+     *        called on this thread while the parse is running
+     * @param origin script origin
+     * @param times output, parse and wait timings
+     * @return compiled script or empty handle on syntax error
+     */
+    v8::MaybeLocal<v8::Script> compile(v8::Local<v8::Context>& ctx, const char* code, size_t code_len,
+            const std::function<v8::Local<v8::String>()>& make_source_val, v8::ScriptOrigin& origin,
+            v8_streaming_times& times);
+
+    static v8_script_streamer& shared();
+};
+
+} // namespace
+}
+
+#endif /* WILTON_V8_SCRIPT_STREAMER_HPP */
+
@@ -0,0 +1,227 @@
+/*
+ * Copyright 2026, agent
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * File:   v8_source_store.cpp
+ * Author: agent
+ */
+
+#include "v8_source_store.hpp"
+
+#ifdef __linux__
+#include <sys/stat.h>
+#endif // __linux__
+
+#include "staticlib/support.hpp"
+#include "staticlib/utils.hpp"
+
+#include "wilton/wilton.h"
+#include "wilton/wilton_loader.h"
+
+#include "wilton/support/exception.hpp"
+
+namespace wilton {
+namespace v8eng {
+
+namespace { // anonymous
+
+const std::string file_prefix = "file://";
+
+sl::json::value json_u64(uint64_t num) {
+    return sl::json::value(static_cast<int64_t>(num));
+}
+
+bool check_ascii(const char* data, size_t len) {
+    for (size_t i = 0; i < len; i++) {
+        if (0 != (static_cast<unsigned char>(data[i]) & 0x80)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// owned by the string, disposed by V8 when the string is collected
+// or when the isolate is disposed
+class external_source_resource : public v8::String::ExternalOneByteStringResource {
+    std::shared_ptr<v8_shared_source> source;
+
+public:
+    explicit external_source_resource(std::shared_ptr<v8_shared_source> source) :
+    source(std::move(source)) { }
+
+    const char* data() const override {
+        return source->data();
+    }
+
+    size_t length() const override {
+        return source->length();
+    }
+};
+
+std::shared_ptr<std::string> load_resource(const std::string& path) {
+    char* code = nullptr;
+    int code_len = 0;
+    auto err_load = wilton_load_resource(path.c_str(), static_cast<int>(path.length()),
+            std::addressof(code), std::addressof(code_len));
+    if (nullptr != err_load) {
+        support::throw_wilton_error(err_load, TRACEMSG(err_load));
+    }
+    auto deferred = sl::support::defer([code] () STATICLIB_NOEXCEPT {
+        wilton_free(code);
+    });
+    return std::make_shared<std::string>(code, static_cast<size_t>(code_len));
+}
+
+} // namespace
+
+v8_shared_source::v8_shared_source(std::shared_ptr<std::string> code) :
+code(std::move(code)),
+ascii(check_ascii(this->code->data(), this->code->length())) { }
+
+const char* v8_shared_source::data() const {
+    return code->data();
+}
+
+size_t v8_shared_source::length() const {
+    return code->length();
+}
+
+bool v8_shared_source::is_ascii() const {
+    return ascii;
+}
+
+v8_source_store::v8_source_store() :
+enabled(false),
+loaded(0),
+loaded_bytes(0),
+hits(0),
+preloaded(0),
+reloads(0),
+external_strings(0),
+copied_strings(0) { }
+
+void v8_source_store::configure(bool enabled) {
+    this->enabled.store(enabled, std::memory_order_release);
+}
+
+bool v8_source_store::is_enabled() const {
+    return enabled.load(std::memory_order_acquire);
+}
+
+std::shared_ptr<v8_shared_source> v8_source_store::load(const std::string& path,
+        std::shared_ptr<std::string> preloaded_code) {
+    int64_t mtime = 0;
+    uint64_t size = 0;
+#ifdef __linux__
+    // files are checked on every load to pick up changes,
+    // sources from other loaders are considered immutable
+    if (sl::utils::starts_with(path, file_prefix)) {
+        auto file_path = path.substr(file_prefix.length());
+        struct stat st;
+        if (0 == ::stat(file_path.c_str(), std::addressof(st))) {
+            mtime = static_cast<int64_t>(st.st_mtim.tv_sec) * 1000000000 + st.st_mtim.tv_nsec;
+            size = static_cast<uint64_t>(st.st_size);
+        }
+    }
+#endif // __linux__
+    bool exists = false;
+    auto found = find_entry(path, mtime, size, exists);
+    if (nullptr != found.get()) {
+        hits.fetch_add(1, std::memory_order_relaxed);
+        return found;
+    }
+    // preloaded copy is taken as is, but only until the module changes
+    if (!exists && nullptr != preloaded_code.get()) {
+        preloaded.fetch_add(1, std::memory_order_relaxed);
+        auto source = std::make_shared<v8_shared_source>(std::move(preloaded_code));
+        put_entry(path, source, mtime, size);
+        return source;
+    }
+    // file changed between the check and the read is read again on next load
+    auto code = load_resource(path);
+    loaded.fetch_add(1, std::memory_order_relaxed);
+    loaded_bytes.fetch_add(static_cast<uint64_t>(code->length()), std::memory_order_relaxed);
+    auto source = std::make_shared<v8_shared_source>(std::move(code));
+    put_entry(path, source, mtime, size);
+    return source;
+}
+
+v8::Local<v8::String> v8_source_store::to_jsval(v8::Isolate* isolate, std::shared_ptr<v8_shared_source> source) {
+    v8::EscapableHandleScope handle_scope(isolate);
+    if (source->is_ascii() && source->length() > 0) {
+        auto resource = new external_source_resource(source);
+        auto maybe = v8::String::NewExternalOneByte(isolate, resource);
+        if (!maybe.IsEmpty()) {
+            external_strings.fetch_add(1, std::memory_order_relaxed);
+            return handle_scope.Escape(maybe.ToLocalChecked());
+        }
+        // resource is not taken by V8 when string cannot be created
+        delete resource;
+    }
+    copied_strings.fetch_add(1, std::memory_order_relaxed);
+    auto maybe = v8::String::NewFromUtf8(isolate, source->data(),
+            v8::NewStringType::kNormal, static_cast<int>(source->length()));
+    if (maybe.IsEmpty()) {
+        auto empty = v8::String::NewFromUtf8(isolate, "", v8::NewStringType::kNormal).ToLocalChecked();
+        return handle_scope.Escape(empty);
+    }
+    return handle_scope.Escape(maybe.ToLocalChecked());
+}
+
+sl::json::value v8_source_store::stats() const {
+    return {
+        { "enabled", is_enabled() },
+        { "loaded", json_u64(loaded.load(std::memory_order_relaxed)) },
+        { "loaded_bytes", json_u64(loaded_bytes.load(std::memory_order_relaxed)) },
+        { "hits", json_u64(hits.load(std::memory_order_relaxed)) },
+        { "preloaded", json_u64(preloaded.load(std::memory_order_relaxed)) },
+        { "reloads", json_u64(reloads.load(std::memory_order_relaxed)) },
+        { "external_strings", json_u64(external_strings.load(std::memory_order_relaxed)) },
+        { "copied_strings", json_u64(copied_strings.load(std::memory_order_relaxed)) }
+    };
+}
+
+v8_source_store& v8_source_store::shared() {
+    static v8_source_store store;
+    return store;
+}
+
+std::shared_ptr<v8_shared_source> v8_source_store::find_entry(const std::string& path,
+        int64_t mtime, uint64_t size, bool& exists) {
+    std::lock_guard<std::mutex> guard{mutex};
+    auto it = entries.find(path);
+    exists = entries.end() != it;
+    if (!exists) {
+        return std::shared_ptr<v8_shared_source>();
+    }
+    if (it->second.mtime != mtime || it->second.size != size) {
+        reloads.fetch_add(1, std::memory_order_relaxed);
+        return std::shared_ptr<v8_shared_source>();
+    }
+    return it->second.source;
+}
+
+void v8_source_store::put_entry(const std::string& path, std::shared_ptr<v8_shared_source> source,
+        int64_t mtime, uint64_t size) {
+    std::lock_guard<std::mutex> guard{mutex};
+    auto& en = entries[path];
+    en.source = std::move(source);
+    en.mtime = mtime;
+    en.size = size;
+}
+
+} // namespace
+}
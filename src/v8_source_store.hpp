@@ -0,0 +1,142 @@
+/*
+ * Copyright 2026, agent
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * File:   v8_source_store.hpp
+ * Author: agent
+ */
+
+#ifndef WILTON_V8_SOURCE_STORE_HPP
+#define WILTON_V8_SOURCE_STORE_HPP
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+#include "v8.h"
+
+#include "staticlib/config.hpp"
+#include "staticlib/json.hpp"
+
+namespace wilton {
+namespace v8eng {
+
+/**
+ * Module source that exists once per process, it is held in a single
+ * heap copy, files are not mapped because in-place rewrites would change
+ * live strings and truncation would fault on access
+ */
+class v8_shared_source {
+    std::shared_ptr<std::string> code;
+    bool ascii = false;
+
+public:
+    explicit v8_shared_source(std::shared_ptr<std::string> code);
+
+    v8_shared_source(const v8_shared_source&) = delete;
+
+    v8_shared_source& operator=(const v8_shared_source&) = delete;
+
+    const char* data() const;
+
+    size_t length() const;
+
+    /**
+     * ASCII sources have the same representation in UTF-8 and in
+     * Latin-1, so they can be used by V8 without conversion
+     */
+    bool is_ascii() const;
+};
+
+/**
+ * Process-wide store of module sources, JS strings for ASCII
+ * sources are created as external strings that reference the
+ * shared memory instead of copying it into every isolate heap
+ */
+class v8_source_store {
+    class entry {
+    public:
+        std::shared_ptr<v8_shared_source> source;
+        int64_t mtime = 0;
+        uint64_t size = 0;
+    };
+
+    std::mutex mutex;
+    std::unordered_map<std::string, entry> entries;
+    std::atomic<bool> enabled;
+
+    std::atomic<uint64_t> loaded;
+    std::atomic<uint64_t> loaded_bytes;
+    std::atomic<uint64_t> hits;
+    std::atomic<uint64_t> preloaded;
+    std::atomic<uint64_t> reloads;
+    std::atomic<uint64_t> external_strings;
+    std::atomic<uint64_t> copied_strings;
+
+public:
+    v8_source_store();
+
+    v8_source_store(const v8_source_store&) = delete;
+
+    v8_source_store& operator=(const v8_source_store&) = delete;
+
+    void configure(bool enabled);
+
+    bool is_enabled() const;
+
+    /**
+     * Returns shared source for the specified module, files are
+     * read again when their size or modification time changes,
+     * previous copy stays alive while it is used by isolates
+     *
+     * @param path module path in the same form it is passed to 'WILTON_load'
+     * @param preloaded source read by the preloader, used instead of reading
+     *        the module when it is not in the store yet, may be null
+     * @return module source
+     */
+    std::shared_ptr<v8_shared_source> load(const std::string& path,
+            std::shared_ptr<std::string> preloaded = std::shared_ptr<std::string>());
+
+    /**
+     * Creates JS string for the source, external string is
+     * used for ASCII sources, others are copied as UTF-8
+     *
+     * @param isolate current isolate
+     * @param source source, it is kept alive by the string
+     * @return JS string
+     */
+    v8::Local<v8::String> to_jsval(v8::Isolate* isolate, std::shared_ptr<v8_shared_source> source);
+
+    sl::json::value stats() const;
+
+    static v8_source_store& shared();
+
+private:
+    std::shared_ptr<v8_shared_source> find_entry(const std::string& path, int64_t mtime, uint64_t size,
+            bool& exists);
+
+    void put_entry(const std::string& path, std::shared_ptr<v8_shared_source> source,
+            int64_t mtime, uint64_t size);
+};
+
+} // namespace
+}
+
+#endif /* WILTON_V8_SOURCE_STORE_HPP */
+
@@ -0,0 +1,256 @@
+/*
+ * Copyright 2026, agent
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * File:   v8_watchdog.cpp
+ * Author: agent
+ */
+
+#include "v8_watchdog.hpp"
+
+#include <algorithm>
+
+#ifdef __linux__
+#include <pthread.h>
+#include <time.h>
+#endif // __linux__
+
+#include "staticlib/support.hpp"
+
+#include "wilton/support/logging.hpp"
+
+namespace wilton {
+namespace v8eng {
+
+namespace { // anonymous
+
+// power of two, budgets longer than a wheel turn wait for several turns
+const size_t wheel_size = 512;
+
+std::atomic<bool> watchdog_created{false};
+
+sl::json::value json_u64(uint64_t num) {
+    return sl::json::value(static_cast<int64_t>(num));
+}
+
+#ifdef __linux__
+uint64_t cpu_clock_ns(clockid_t clock) {
+    struct timespec ts;
+    if (0 != clock_gettime(clock, std::addressof(ts))) {
+        return 0;
+    }
+    return static_cast<uint64_t>(ts.tv_sec) * 1000000000 + static_cast<uint64_t>(ts.tv_nsec);
+}
+#endif // __linux__
+
+} // namespace
+
+v8_watchdog::v8_watchdog(uint16_t tick_ms) :
+tick(std::max(tick_ms, static_cast<uint16_t>(1))),
+started_at(std::chrono::steady_clock::now()),
+wheel(wheel_size),
+armed_count(0),
+fired_count(0) { }
+
+v8_watchdog::~v8_watchdog() STATICLIB_NOEXCEPT {
+    {
+        std::lock_guard<std::mutex> guard{mutex};
+        stopping = true;
+    }
+    cv.notify_all();
+    if (worker.joinable()) {
+        worker.join();
+    }
+}
+
+uint64_t v8_watchdog::arm(v8::Isolate* isolate, uint32_t budget_ms, bool cpu,
+        std::function<void()> on_fire) {
+    auto en = entry();
+    en.isolate = isolate;
+    en.on_fire = std::move(on_fire);
+    en.budget_ns = static_cast<uint64_t>(budget_ms) * 1000000;
+#ifdef __linux__
+    if (cpu && 0 == pthread_getcpuclockid(pthread_self(), std::addressof(en.cpu_clock))) {
+        en.cpu = true;
+        en.cpu_start_ns = cpu_clock_ns(en.cpu_clock);
+    }
+#else
+    (void) cpu;
+#endif // __linux__
+    uint64_t id = 0;
+    bool was_empty = false;
+    {
+        std::lock_guard<std::mutex> guard{mutex};
+        // started on first use
+        if (!worker.joinable()) {
+            this->worker = std::thread(&v8_watchdog::run, this);
+        }
+        id = next_id++;
+        was_empty = entries.empty();
+        auto& placed = entries.emplace(id, en).first->second;
+        schedule(id, placed, placed.budget_ns);
+    }
+    armed_count.fetch_add(1, std::memory_order_relaxed);
+    if (was_empty) {
+        cv.notify_one();
+    }
+    return id;
+}
+
+bool v8_watchdog::disarm(uint64_t id) {
+    std::lock_guard<std::mutex> guard{mutex};
+    auto it = entries.find(id);
+    if (entries.end() == it) {
+        return false;
+    }
+    // wheel slot keeps stale id, it is skipped on expiry
+    auto fired = it->second.fired;
+    entries.erase(it);
+    return fired;
+}
+
+bool v8_watchdog::is_fired(uint64_t id) {
+    std::lock_guard<std::mutex> guard{mutex};
+    auto it = entries.find(id);
+    return entries.end() != it && it->second.fired;
+}
+
+sl::json::value v8_watchdog::stats() {
+    size_t active = 0;
+    {
+        std::lock_guard<std::mutex> guard{mutex};
+        active = entries.size();
+    }
+    return {
+        { "tick_ms", static_cast<int64_t>(tick.count()) },
+        { "active", json_u64(active) },
+        { "armed", json_u64(armed_count.load()) },
+        { "fired", json_u64(fired_count.load()) }
+    };
+}
+
+v8_watchdog& v8_watchdog::shared(uint16_t tick_ms) {
+    // tick is taken from the first call made from v8_engine::initialize,
+    // never destroyed, engines may be disposed from static destructors
+    static v8_watchdog* watchdog = new v8_watchdog(tick_ms);
+    watchdog_created.store(true, std::memory_order_release);
+    return *watchdog;
+}
+
+bool v8_watchdog::is_created() {
+    return watchdog_created.load(std::memory_order_acquire);
+}
+
+uint64_t v8_watchdog::tick_of(std::chrono::steady_clock::time_point tp) const {
+    auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(tp - started_at);
+    return static_cast<uint64_t>(elapsed.count() / tick.count());
+}
+
+void v8_watchdog::schedule(uint64_t id, entry& en, uint64_t delay_ns) {
+    auto delay = std::chrono::nanoseconds(static_cast<int64_t>(delay_ns));
+    // rounded up, budget is never cut short
+    auto deadline = tick_of(std::chrono::steady_clock::now() + delay) + 1;
+    en.deadline_tick = std::max(deadline, current_tick + 1);
+    wheel[en.deadline_tick % wheel_size].push_back(id);
+}
+
+void v8_watchdog::expire(uint64_t id, entry& en) {
+#ifdef __linux__
+    if (en.cpu) {
+        // wall time is an upper bound of the thread CPU time
+        auto used = cpu_clock_ns(en.cpu_clock) - en.cpu_start_ns;
+        if (used < en.budget_ns) {
+            schedule(id, en, en.budget_ns - used);
+            return;
+        }
+    }
+#endif // __linux__
+    en.fired = true;
+    en.isolate->TerminateExecution();
+    if (en.on_fire) {
+        en.on_fire();
+    }
+    fired_count.fetch_add(1, std::memory_order_relaxed);
+}
+
+void v8_watchdog::run() {
+    std::unique_lock<std::mutex> guard{mutex};
+    for (;;) {
+        if (entries.empty()) {
+            cv.wait(guard, [this] {
+                return stopping || !entries.empty();
+            });
+        } else {
+            cv.wait_until(guard, started_at + tick * (current_tick + 1), [this] {
+                return stopping;
+            });
+        }
+        if (stopping) {
+            return;
+        }
+        // slots missed while sleeping are processed to catch up
+        auto now_tick = tick_of(std::chrono::steady_clock::now());
+        if (now_tick - current_tick > wheel_size) {
+            current_tick = now_tick - wheel_size;
+        }
+        while (current_tick < now_tick) {
+            current_tick += 1;
+            auto slot = std::vector<uint64_t>();
+            slot.swap(wheel[current_tick % wheel_size]);
+            for (auto id : slot) {
+                auto it = entries.find(id);
+                if (entries.end() == it || it->second.fired) {
+                    continue;
+                }
+                auto& en = it->second;
+                if (en.deadline_tick > current_tick) {
+                    // later turn of the wheel
+                    wheel[current_tick % wheel_size].push_back(id);
+                } else {
+                    expire(id, en);
+                }
+            }
+        }
+    }
+}
+
+v8_watchdog_scope::v8_watchdog_scope(v8::Isolate* isolate, uint32_t budget_ms, bool cpu,
+        std::function<void()> on_fire) :
+isolate(isolate) {
+    if (budget_ms > 0) {
+        this->id = v8_watchdog::shared().arm(isolate, budget_ms, cpu, std::move(on_fire));
+    }
+}
+
+v8_watchdog_scope::~v8_watchdog_scope() STATICLIB_NOEXCEPT {
+    if (0 != id && v8_watchdog::shared().disarm(id)) {
+        // termination requested after the callback finished must not hit the next one
+        isolate->CancelTerminateExecution();
+    }
+}
+
+bool v8_watchdog_scope::timed_out() {
+    if (0 != id && v8_watchdog::shared().is_fired(id)) {
+        v8_watchdog::shared().disarm(id);
+        this->id = 0;
+        this->fired = true;
+        isolate->CancelTerminateExecution();
+    }
+    return fired;
+}
+
+} // namespace
+}
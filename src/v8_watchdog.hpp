@@ -0,0 +1,171 @@
+/*
+ * Copyright 2026, agent
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * File:   v8_watchdog.hpp
+ * Author: agent
+ */
+
+#ifndef WILTON_V8_WATCHDOG_HPP
+#define WILTON_V8_WATCHDOG_HPP
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "v8.h"
+
+#include "staticlib/config.hpp"
+#include "staticlib/json.hpp"
+
+namespace wilton {
+namespace v8eng {
+
+/**
+ * Single thread enforcing callback time budgets for all engines,
+ * budgets are tracked in a hashed timer wheel and the isolate
+ * running over the budget is terminated
+ */
+class v8_watchdog {
+    class entry {
+    public:
+        v8::Isolate* isolate = nullptr;
+        uint64_t deadline_tick = 0;
+        uint64_t budget_ns = 0;
+        // thread CPU clock is checked on expiry when CPU budget is used
+        bool cpu = false;
+        uint64_t cpu_start_ns = 0;
+#ifdef __linux__
+        clockid_t cpu_clock;
+#endif // __linux__
+        bool fired = false;
+        // wakes up the engine blocked outside of JS
+        std::function<void()> on_fire;
+    };
+
+    std::mutex mutex;
+    std::condition_variable cv;
+    std::thread worker;
+    bool stopping = false;
+
+    std::chrono::milliseconds tick;
+    std::chrono::steady_clock::time_point started_at;
+    uint64_t current_tick = 0;
+    std::vector<std::vector<uint64_t>> wheel;
+    std::unordered_map<uint64_t, entry> entries;
+    uint64_t next_id = 1;
+
+    std::atomic<uint64_t> armed_count;
+    std::atomic<uint64_t> fired_count;
+
+public:
+    explicit v8_watchdog(uint16_t tick_ms);
+
+    ~v8_watchdog() STATICLIB_NOEXCEPT;
+
+    v8_watchdog(const v8_watchdog&) = delete;
+
+    v8_watchdog& operator=(const v8_watchdog&) = delete;
+
+    /**
+     * Starts watching the callback, must be called on the thread
+     * that runs the callback
+     *
+     * @param isolate isolate to terminate
+     * @param budget_ms time budget
+     * @param cpu whether the budget is measured in thread CPU time
+     * @param on_fire called from the watchdog thread after the termination
+     *        is requested, must not block
+     * @return watch id
+     */
+    uint64_t arm(v8::Isolate* isolate, uint32_t budget_ms, bool cpu,
+            std::function<void()> on_fire = std::function<void()>());
+
+    /**
+     * Stops watching, termination is never requested after this call
+     *
+     * @param id watch id
+     * @return whether the isolate was terminated
+     */
+    bool disarm(uint64_t id);
+
+    bool is_fired(uint64_t id);
+
+    sl::json::value stats();
+
+    static v8_watchdog& shared(uint16_t tick_ms = 10);
+
+    /**
+     * Allows to read stats without instantiating the watchdog
+     *
+     * @return whether 'shared' was called
+     */
+    static bool is_created();
+
+private:
+    uint64_t tick_of(std::chrono::steady_clock::time_point tp) const;
+
+    void schedule(uint64_t id, entry& en, uint64_t delay_ns);
+
+    void expire(uint64_t id, entry& en);
+
+    void run();
+};
+
+/**
+ * Watches a single callback run
+ */
+class v8_watchdog_scope {
+    v8::Isolate* isolate;
+    uint64_t id = 0;
+    bool fired = false;
+
+public:
+    /**
+     * @param isolate isolate running the callback, must be locked
+     * @param budget_ms time budget, 0 to not watch
+     * @param cpu whether the budget is measured in thread CPU time
+     * @param on_fire called from the watchdog thread on termination
+     */
+    v8_watchdog_scope(v8::Isolate* isolate, uint32_t budget_ms, bool cpu,
+            std::function<void()> on_fire = std::function<void()>());
+
+    ~v8_watchdog_scope() STATICLIB_NOEXCEPT;
+
+    v8_watchdog_scope(const v8_watchdog_scope&) = delete;
+
+    v8_watchdog_scope& operator=(const v8_watchdog_scope&) = delete;
+
+    /**
+     * Checks whether the callback was terminated by the watchdog,
+     * the termination is cancelled so the isolate can be reused
+     *
+     * @return whether the budget is exceeded
+     */
+    bool timed_out();
+};
+
+} // namespace
+}
+
+#endif /* WILTON_V8_WATCHDOG_HPP */
+
@@ -21,21 +21,30 @@
  * Created on May 8, 2018, 9:59 PM
  */
 
+#include <atomic>
 #include <cstdio>
 #include <memory>
+#include <mutex>
 #include <string>
 
 #include "staticlib/config.hpp"
 #include "staticlib/io.hpp"
+#include "staticlib/json.hpp"
 
 #include "wilton/wilton.h"
 
 #include "wilton/support/buffer.hpp"
 #include "wilton/support/exception.hpp"
+#include "wilton/support/logging.hpp"
 #include "wilton/support/registrar.hpp"
 #include "wilton/support/script_engine_map.hpp"
 
+#include "v8_config.hpp"
+#include "v8_cpu_profiler.hpp"
 #include "v8_engine.hpp"
+#include "v8_engine_map.hpp"
+#include "v8_engine_pool.hpp"
+#include "v8_heap_profiler.hpp"
 
 namespace wilton {
 namespace v8eng {
@@ -46,18 +55,177 @@ std::shared_ptr<support::script_engine_map<v8_engine>> shared_tlmap() {
     return tlmap;
 }
 
+// initialized from wilton_module_init, used instead
+// of thread-local engines if pool size is configured
+std::shared_ptr<v8_engine_pool>& shared_pool() {
+    static std::shared_ptr<v8_engine_pool> pool;
+    return pool;
+}
+
+// initialized from wilton_module_init, used instead of 'script_engine_map'
+// if spare engines or recycling limits are configured
+std::shared_ptr<v8_engine_map>& shared_engine_map() {
+    static std::shared_ptr<v8_engine_map> map;
+    return map;
+}
+
+// init code is resolved by wilton core only for the engines constructed by
+// 'script_engine_map', it is obtained by running the map with this stand-in
+class init_code_probe {
+public:
+    explicit init_code_probe(sl::io::span<const char> init_code) {
+        captured() = std::make_shared<const std::string>(init_code.data(), init_code.size());
+    }
+
+    support::buffer run_callback_script(sl::io::span<const char>) {
+        return support::make_null_buffer();
+    }
+
+    void run_garbage_collector() { }
+
+    // accessed under the lock in 'core_init_code'
+    static std::shared_ptr<const std::string>& captured() {
+        static std::shared_ptr<const std::string> code;
+        return code;
+    }
+};
+
+std::shared_ptr<const std::string> core_init_code() {
+    static std::mutex mutex;
+    std::lock_guard<std::mutex> guard{mutex};
+    auto& code = init_code_probe::captured();
+    if (nullptr == code.get()) {
+        support::script_engine_map<init_code_probe> probe_map;
+        probe_map.run_script({"", 0});
+    }
+    if (nullptr == code.get()) {
+        throw support::exception(TRACEMSG("Engine init code is not available"));
+    }
+    return code;
+}
+
+// the pool and the spare engines map cannot build engines until the init code is set,
+// it is set from 'wilton_module_init', or on the first call if that attempt failed
+void provide_init_code() {
+    static std::atomic<bool> provided{false};
+    if (provided.load(std::memory_order_acquire)) {
+        return;
+    }
+    auto code = core_init_code();
+    auto pool = shared_pool();
+    if (nullptr != pool.get()) {
+        pool->set_init_code(code);
+    }
+    auto map = shared_engine_map();
+    if (nullptr != map.get()) {
+        map->set_init_code(code);
+    }
+    provided.store(true, std::memory_order_release);
+}
+
 support::buffer runscript(sl::io::span<const char> data) {
+    auto pool = shared_pool();
+    if (nullptr != pool.get()) {
+        provide_init_code();
+        return pool->run_script(data);
+    }
+    auto map = shared_engine_map();
+    if (nullptr != map.get()) {
+        provide_init_code();
+        return map->run_script(data);
+    }
     auto tlmap = shared_tlmap();
     return tlmap->run_script(data);
 }
 
 support::buffer rungc(sl::io::span<const char>) {
+    auto pool = shared_pool();
+    if (nullptr != pool.get()) {
+        pool->run_garbage_collector();
+        return support::make_null_buffer();
+    }
+    auto map = shared_engine_map();
+    if (nullptr != map.get()) {
+        map->run_garbage_collector();
+        return support::make_null_buffer();
+    }
     auto tlmap = shared_tlmap();
     tlmap->run_garbage_collector();
     return support::make_null_buffer();
 }
 
+support::buffer codecachestats(sl::io::span<const char>) {
+    auto stats = v8_engine::code_cache_stats();
+    return support::make_json_buffer(stats);
+}
+
+support::buffer stats(sl::io::span<const char>) {
+    auto stats = v8_engine::stats();
+    auto pool = shared_pool();
+    if (nullptr != pool.get()) {
+        auto& fields = stats.as_object_or_throw();
+        fields.emplace_back("pool", pool->stats());
+    }
+    auto map = shared_engine_map();
+    if (nullptr != map.get()) {
+        auto& fields = stats.as_object_or_throw();
+        fields.emplace_back("spares", map->stats());
+    }
+    return support::make_json_buffer(stats);
+}
+
+sl::json::value load_options(sl::io::span<const char> data) {
+    if (0 == data.size()) {
+        return sl::json::value(std::vector<sl::json::field>());
+    }
+    return sl::json::load(data);
+}
+
+support::buffer startcpuprofile(sl::io::span<const char> data) {
+    auto options = load_options(data);
+    auto res = v8_cpu_profiler_registry::shared().start(options);
+    return support::make_json_buffer(res);
+}
+
+support::buffer stopcpuprofile(sl::io::span<const char> data) {
+    auto options = load_options(data);
+    auto res = v8_cpu_profiler_registry::shared().stop(options);
+    return support::make_json_buffer(res);
+}
+
+support::buffer cpuprofilestatus(sl::io::span<const char>) {
+    auto res = v8_cpu_profiler_registry::shared().status();
+    return support::make_json_buffer(res);
+}
+
+support::buffer heapsnapshot(sl::io::span<const char> data) {
+    auto options = load_options(data);
+    auto res = v8_heap_profiler_registry::shared().write_snapshots(options);
+    return support::make_json_buffer(res);
+}
+
+support::buffer startheapsampling(sl::io::span<const char> data) {
+    auto options = load_options(data);
+    auto res = v8_heap_profiler_registry::shared().start_sampling(options);
+    return support::make_json_buffer(res);
+}
+
+support::buffer stopheapsampling(sl::io::span<const char> data) {
+    auto options = load_options(data);
+    auto res = v8_heap_profiler_registry::shared().stop_sampling(options);
+    return support::make_json_buffer(res);
+}
+
+support::buffer heapprofilestatus(sl::io::span<const char>) {
+    auto res = v8_heap_profiler_registry::shared().status();
+    return support::make_json_buffer(res);
+}
+
 void clean_tls(void*, const char* thread_id, int thread_id_len) {
+    auto map = shared_engine_map();
+    if (nullptr != map.get()) {
+        map->clean_thread_local(thread_id, thread_id_len);
+    }
     auto tlmap = shared_tlmap();
     tlmap->clean_thread_local(thread_id, thread_id_len);
 }
@@ -71,10 +239,35 @@ extern "C" char* wilton_module_init() {
                 " consider using JavaScriptCore engine instead");
         wilton::v8eng::v8_engine::initialize();
         wilton::v8eng::shared_tlmap();
+        auto cfg = wilton::v8eng::v8_config::from_wilton_config();
+        if (cfg.isolate_pool_size > 0) {
+            wilton::v8eng::shared_pool() = std::make_shared<wilton::v8eng::v8_engine_pool>(
+                    cfg.isolate_pool_size, cfg.isolate_pool_lease_timeout_ms);
+        } else if (cfg.spare_engines > 0 || cfg.recycling_enabled()) {
+            wilton::v8eng::shared_engine_map() = std::make_shared<wilton::v8eng::v8_engine_map>(
+                    cfg.spare_engines);
+        }
+        if (cfg.isolate_pool_size > 0 || cfg.spare_engines > 0 || cfg.recycling_enabled()) {
+            try {
+                wilton::v8eng::provide_init_code();
+            } catch (const std::exception& e) {
+                wilton::support::log_warn("wilton.engine.v8.init", TRACEMSG(e.what() +
+                        "\nError resolving engine init code, it will be resolved on the first call"));
+            }
+        }
         auto err = wilton_register_tls_cleaner(nullptr, wilton::v8eng::clean_tls);
         if (nullptr != err) wilton::support::throw_wilton_error(err, TRACEMSG(err));
         wilton::support::register_wiltoncall("runscript_v8", wilton::v8eng::runscript);
         wilton::support::register_wiltoncall("rungc_v8", wilton::v8eng::rungc);
+        wilton::support::register_wiltoncall("stats_v8", wilton::v8eng::stats);
+        wilton::support::register_wiltoncall("codecachestats_v8", wilton::v8eng::codecachestats);
+        wilton::support::register_wiltoncall("startcpuprofile_v8", wilton::v8eng::startcpuprofile);
+        wilton::support::register_wiltoncall("stopcpuprofile_v8", wilton::v8eng::stopcpuprofile);
+        wilton::support::register_wiltoncall("cpuprofilestatus_v8", wilton::v8eng::cpuprofilestatus);
+        wilton::support::register_wiltoncall("heapsnapshot_v8", wilton::v8eng::heapsnapshot);
+        wilton::support::register_wiltoncall("startheapsampling_v8", wilton::v8eng::startheapsampling);
+        wilton::support::register_wiltoncall("stopheapsampling_v8", wilton::v8eng::stopheapsampling);
+        wilton::support::register_wiltoncall("heapprofilestatus_v8", wilton::v8eng::heapprofilestatus);
         return nullptr;
     } catch (const std::exception& e) {
         return wilton::support::alloc_copy(TRACEMSG(e.what() + "\nException raised"));